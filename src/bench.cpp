@@ -0,0 +1,547 @@
+// INAA License @marecl 2025
+
+#include <chrono>
+#include <fstream>
+#include <cstdlib>
+#include <new>
+
+#include "quasifs/quasifs_dedup.h"
+#include "quasifs/quasifs_inode_directory.h"
+#include "quasifs/quasifs_inode_regularfile.h"
+#include "quasifs/quasifs_mapping.h"
+#include "quasifs/quasifs_partition.h"
+#include "quasifs/quasifs.h"
+#include "quasifs/quasi_sys_fcntl.h"
+
+#include "log.h"
+
+using namespace QuasiFS;
+
+//
+// Allocation counter
+// Every global operator new goes through here
+//
+
+static uint64_t alloc_count = 0;
+
+void *operator new(std::size_t size)
+{
+    alloc_count++;
+    if (void *ptr = std::malloc(size ? size : 1))
+        return ptr;
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { std::free(ptr); }
+
+template <typename Fn>
+void Bench(const std::string_view name, uint64_t iterations, Fn &&fn)
+{
+    uint64_t allocs_start = alloc_count;
+    auto time_start = std::chrono::steady_clock::now();
+
+    for (uint64_t idx = 0; idx < iterations; idx++)
+        fn();
+
+    auto time_end = std::chrono::steady_clock::now();
+    uint64_t allocs = alloc_count - allocs_start;
+    double ns = std::chrono::duration<double, std::nano>(time_end - time_start).count();
+
+    Log("{:<40} {:>10.1f} ns/op {:>8.2f} allocs/op", name, ns / iterations, static_cast<double>(allocs) / iterations);
+}
+
+template <typename Fn>
+void Throughput(const std::string_view name, uint64_t bytes, uint64_t iterations, Fn &&fn)
+{
+    auto time_start = std::chrono::steady_clock::now();
+
+    for (uint64_t idx = 0; idx < iterations; idx++)
+        fn();
+
+    auto time_end = std::chrono::steady_clock::now();
+    double seconds = std::chrono::duration<double>(time_end - time_start).count();
+
+    Log("{:<40} {:>10.2f} GB/s", name, static_cast<double>(bytes) * iterations / seconds / 1e9);
+}
+
+//
+// Path resolution
+//
+
+void BenchResolve(void)
+{
+    Log("<<<< PATH RESOLUTION >>>>");
+
+    const uint64_t iterations = 200000;
+    partition_ptr part = Partition::Create();
+
+    dir_ptr dir = part->GetRoot();
+    for (const char *name : {"savedata", "user_00000001", "title", "CUSA00001", "sce_sys"})
+    {
+        part->mkdir(dir, name);
+        dir = std::static_pointer_cast<Directory>(dir->lookup(name));
+    }
+    part->touch(dir, "param.sfo", RegularFile::Create());
+
+    fs::path path = "/savedata/user_00000001/title/CUSA00001/sce_sys/param.sfo";
+    Resolved res;
+
+    Bench("Partition::Resolve (fs::path)", iterations, [&]()
+          { part->Resolve(path, res); });
+
+    Bench("Partition::Resolve (string_view)", iterations, [&]()
+          {
+              std::string_view path_view = path.native();
+              std::string_view local_path{};
+              part->Resolve(path_view, res, local_path); });
+
+    QFS qfs;
+    qfs.Operation.MKDir("/mnt");
+    qfs.Mount("/mnt", part, MountOptions::MOUNT_RW);
+    qfs.Operation.LinkSymbolic("/mnt/savedata/user_00000001", "/user");
+
+    fs::path qfs_path = "/user/title/CUSA00001/sce_sys/param.sfo";
+
+    Bench("QFS::Resolve (mount + symlink, cached)", iterations, [&]()
+          { qfs.Resolve(qfs_path, res); });
+
+    Bench("QFS::Resolve (mount + symlink, uncached)", iterations, [&]()
+          {
+              DentryCache::Invalidate();
+              qfs.Resolve(qfs_path, res); });
+
+    fs::path missing_path = "/user/title/CUSA00001/sce_sys/override.cfg";
+
+    Bench("QFS::Resolve (missing, cached)", iterations, [&]()
+          { qfs.Resolve(missing_path, res); });
+
+    Bench("QFS::Resolve (missing, uncached)", iterations, [&]()
+          {
+              DentryCache::Invalidate();
+              qfs.Resolve(missing_path, res); });
+
+    // relative walk is never cached, symlink is followed every time
+    int rootfd = qfs.Operation.Open("/", QUASI_O_RDONLY | QUASI_O_DIRECTORY);
+    fs::path relative_path = "user/title/CUSA00001/sce_sys/param.sfo";
+
+    Bench("QFS::ResolveAt (root dirfd, symlink)", iterations, [&]()
+          { qfs.ResolveAt(rootfd, relative_path, res); });
+
+    qfs.Operation.Close(rootfd);
+
+    int dirfd = qfs.Operation.Open("/user/title/CUSA00001/sce_sys", QUASI_O_RDONLY | QUASI_O_DIRECTORY);
+
+    Bench("QFS::ResolveAt (dirfd + leaf)", iterations, [&]()
+          { qfs.ResolveAt(dirfd, "param.sfo", res); });
+
+    qfs.Operation.Close(dirfd);
+}
+
+void BenchResolveMany(void)
+{
+    Log("<<<< BATCHED PATH RESOLUTION >>>>");
+
+    const uint64_t iterations = 50;
+    QFS qfs;
+    partition_ptr part = Partition::Create();
+    qfs.Operation.MKDir("/app0");
+    qfs.Mount("/app0", part, MountOptions::MOUNT_RW);
+    qfs.Operation.MKDir("/app0/assets");
+
+    // 16 x 16 x 16 asset tree, every file shares at least /app0/assets prefix
+    std::vector<fs::path> paths{};
+    for (int group = 0; group < 16; group++)
+    {
+        fs::path group_path = std::format("/app0/assets/group_{:02}", group);
+        qfs.Operation.MKDir(group_path);
+        for (int pack = 0; pack < 16; pack++)
+        {
+            fs::path pack_path = group_path / std::format("pack_{:02}", pack);
+            qfs.Operation.MKDir(pack_path);
+            for (int file = 0; file < 16; file++)
+            {
+                paths.push_back(pack_path / std::format("texture_{:02}.dds", file));
+                qfs.Operation.Close(qfs.Operation.Creat(paths.back()));
+            }
+        }
+    }
+
+    std::vector<Resolved> res(paths.size());
+    std::vector<int> status(paths.size());
+
+    Bench(std::format("QFS::Resolve loop ({} paths, cold)", paths.size()), iterations, [&]()
+          {
+              DentryCache::Invalidate();
+              for (size_t idx = 0; idx < paths.size(); idx++)
+                  status[idx] = qfs.Resolve(paths[idx], res[idx]); });
+
+    Bench(std::format("QFS::ResolveMany ({} paths, cold)", paths.size()), iterations, [&]()
+          {
+              DentryCache::Invalidate();
+              qfs.ResolveMany(paths, res, status); });
+}
+
+//
+// Directory entries
+//
+
+void BenchDirectory(void)
+{
+    Log("<<<< DIRECTORY ENTRIES >>>>");
+
+    const int entry_count = 50000;
+    std::vector<std::string> names{};
+    for (int idx = 0; idx < entry_count; idx++)
+        names.push_back("shader_cache_entry_" + std::to_string(idx * 7919 % entry_count) + ".bin");
+
+    partition_ptr part = Partition::Create();
+    dir_ptr dir = part->GetRoot();
+
+    Bench(std::format("Directory::link ({} entries)", entry_count), 1, [&]()
+          {
+              for (const std::string &name : names)
+                  dir->link(name, RegularFile::Create()); });
+
+    size_t idx = 0;
+    Bench("Directory::lookup (hit)", 1000000, [&]()
+          {
+              std::string_view name = names[idx++ % entry_count];
+              dir->lookup(name); });
+
+    Bench("Directory::lookup (miss)", 1000000, [&]()
+          { dir->lookup("shader_cache_entry_missing.bin"); });
+
+    Bench(std::format("Directory::list ({} entries)", entry_count), 20, [&]()
+          { dir->list(); });
+
+    std::vector<char> dents(32768);
+    Bench(std::format("Directory::getdents ({} entries, 32 KiB)", entry_count), 20, [&]()
+          {
+              quasi_off_t cursor = 0;
+              while (dir->getdents(dents.data(), dents.size(), &cursor) > 0)
+                  ; });
+}
+
+void BenchInodeTable(void)
+{
+    Log("<<<< INODE TABLE >>>>");
+
+    const int inode_count = 1000000;
+    partition_ptr part = Partition::Create();
+    dir_ptr dir = part->GetRoot();
+    std::vector<std::string> names{};
+    for (int idx = 0; idx < inode_count; idx++)
+        names.push_back(std::to_string(idx));
+
+    Bench(std::format("Partition::touch ({} inodes, heap)", inode_count), inode_count, [&, idx = 0]() mutable
+          { part->touch(dir, names[idx++], RegularFile::Create()); });
+
+    {
+        partition_ptr pooled = Partition::Create();
+        Bench(std::format("Partition::touch ({} inodes, pool)", inode_count), inode_count, [&, idx = 0]() mutable
+              { pooled->touch<RegularFile>(pooled->GetRoot(), names[idx++]); });
+
+        auto time_start = std::chrono::steady_clock::now();
+        pooled.reset();
+        Log("{:<40} {:>10.1f} ms", "Drop pooled partition", std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - time_start).count());
+    }
+
+    fileno_t fileno = 0;
+    Bench("Partition::GetInodeByFileno", 10000000, [&]()
+          {
+              fileno = (fileno * 7919 + 1) % inode_count;
+              part->GetInodeByFileno(fileno + 2); });
+
+    // numbers are recycled, table doesn't grow
+    Bench("Partition::unlink + touch (churn)", 1000000, [&, idx = 0]() mutable
+          {
+              const std::string &name = names[idx++ % inode_count];
+              part->unlink(dir, name);
+              part->touch(dir, name, RegularFile::Create()); });
+
+    // bulk import of a host tree
+    const int host_files = 20000;
+    fs::path host_dir = fs::absolute("bench_sync_host");
+    fs::remove_all(host_dir);
+    for (int idx = 0; idx < host_files; idx++)
+    {
+        fs::path file = host_dir / std::to_string(idx % 100) / std::to_string(idx);
+        fs::create_directories(file.parent_path());
+        std::ofstream{file};
+    }
+
+    QFS qfs;
+    qfs.Operation.MKDir("/sync");
+    Bench(std::format("QFS::SyncHost ({} files)", host_files), 4, [&]()
+          {
+              qfs.Mount("/sync", Partition::Create(host_dir), MountOptions::MOUNT_RW);
+              qfs.SyncHost("/sync");
+              qfs.Unmount("/sync"); });
+    fs::remove_all(host_dir);
+}
+
+//
+// File I/O
+//
+
+void BenchFileIO(void)
+{
+    Log("<<<< FILE I/O >>>>");
+
+    for (quasi_size_t size : {4096UL, 65536UL, 1048576UL, 16777216UL, 67108864UL})
+    {
+        std::vector<char> buffer(size, 'Q');
+        file_ptr file = RegularFile::Create();
+        file->write(0, buffer.data(), size);
+
+        // keep total traffic roughly equal between sizes
+        uint64_t iterations = std::max<uint64_t>(4, (1ULL << 30) / size);
+        std::string label = size >= 1048576 ? std::to_string(size >> 20) + " MiB" : std::to_string(size >> 10) + " KiB";
+
+        Throughput("RegularFile::read (" + label + ")", size, iterations, [&]()
+                   { file->read(0, buffer.data(), size); });
+        Throughput("RegularFile::write (" + label + ")", size, iterations, [&]()
+                   { file->write(0, buffer.data(), size); });
+    }
+
+    // log-style growth, worst single append shows reallocation spikes
+    const quasi_size_t chunk = 4096;
+    const quasi_size_t target = 256 * 1024 * 1024;
+    std::vector<char> buffer(chunk, 'L');
+    file_ptr file = RegularFile::Create();
+    double worst_ns = 0;
+
+    auto time_start = std::chrono::steady_clock::now();
+    for (quasi_size_t pos = 0; pos < target; pos += chunk)
+    {
+        auto append_start = std::chrono::steady_clock::now();
+        file->write(pos, buffer.data(), chunk);
+        worst_ns = std::max(worst_ns, std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - append_start).count());
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - time_start).count();
+
+    Log("{:<40} {:>10.2f} GB/s {:>10.1f} us worst", "RegularFile append (4 KiB to 256 MiB)", target / seconds / 1e9, worst_ns / 1000);
+
+    // duplicate the appended file
+    std::vector<char> copy_buffer(1024 * 1024);
+    Bench("Copy via read/write (256 MiB)", 4, [&]()
+          {
+              file_ptr copy = RegularFile::Create();
+              for (quasi_size_t pos = 0; pos < target; pos += copy_buffer.size())
+              {
+                  file->read(pos, copy_buffer.data(), copy_buffer.size());
+                  copy->write(pos, copy_buffer.data(), copy_buffer.size());
+              } });
+
+    Bench("RegularFile::clone (256 MiB)", 4, [&]()
+          {
+              auto copy = std::make_shared<RegularFile>();
+              copy->clone(*std::static_pointer_cast<RegularFile>(file)); });
+
+    // parse in place vs copy out first
+    std::vector<char> read_buffer(1024 * 1024);
+    uint64_t checksum = 0;
+
+    Throughput("Read into buffer + walk (256 MiB)", target, 4, [&]()
+               {
+                   for (quasi_size_t pos = 0; pos < target; pos += read_buffer.size())
+                   {
+                       file->read(pos, read_buffer.data(), read_buffer.size());
+                       checksum += read_buffer[pos % read_buffer.size()];
+                   } });
+
+    Throughput("FileMapping map + page walk (256 MiB)", target, 4, [&]()
+               {
+                   FileMapping mapping;
+                   mapping.Map(file, 0, target, false);
+                   for (size_t idx = 0; idx < mapping.Segments(); idx++)
+                       checksum += mapping.Segment(idx)[idx % RegularFile::PAGE_SIZE]; });
+
+    // keeps walks from being optimized out
+    Log("checksum {}", checksum);
+}
+
+void BenchTinyFiles(void)
+{
+    Log("<<<< TINY FILES >>>>");
+
+    // lock files, flags, small JSON
+    const char contents[] = "{\"pid\":1234,\"ready\":true}";
+    char buffer[sizeof(contents)];
+    std::vector<file_ptr> files;
+    files.reserve(1000000);
+
+    Bench("Create + write tiny file", 1000000, [&]()
+          {
+              file_ptr file = RegularFile::Create();
+              file->write(0, contents, sizeof(contents));
+              files.push_back(std::move(file)); });
+
+    size_t idx = 0;
+    Bench("Read tiny file", 1000000, [&]()
+          { files[idx++ % files.size()]->read(0, buffer, sizeof(buffer)); });
+
+    files.clear();
+}
+
+void BenchCompression(void)
+{
+    Log("<<<< IDLE FILE COMPRESSION >>>>");
+
+    // log-like text, compresses about as well as real logs do
+    const quasi_size_t target = 64 * 1024 * 1024;
+    std::string contents;
+    contents.reserve(target);
+    for (uint64_t line = 0; contents.size() < target; line++)
+        contents += std::format("[{}] worker {} finished request {} in {} us\n", 1700000000 + line / 7, line % 13, line * 7919 % 100003, line * 31 % 977);
+    contents.resize(target);
+
+    std::vector<char> buffer(1024 * 1024);
+    compression_stats_ptr stats = std::make_shared<CompressionStats>();
+    file_ptr file = RegularFile::Create();
+    file->write(0, contents.data(), target);
+
+    Throughput("RegularFile::sweep (64 MiB text)", target, 1, [&]()
+               { file->sweep(1, stats); });
+    Log("ratio {:.2f}, {} MiB -> {} MiB", stats->Ratio(), stats->original_bytes >> 20, stats->packed_bytes >> 20);
+
+    Throughput("Read compressed file (64 MiB text)", target, 1, [&]()
+               {
+                   for (quasi_size_t pos = 0; pos < target; pos += buffer.size())
+                       file->read(pos, buffer.data(), buffer.size()); });
+    Log("decompression {:.0f} ns/page avg, {} ns worst", stats->AverageUnpackNs(), stats->unpack_max_ns);
+}
+
+void BenchDedup(void)
+{
+    Log("<<<< DEDUPLICATION >>>>");
+
+    const quasi_size_t size = 4 * 1024 * 1024;
+    std::vector<char> contents(size);
+    for (quasi_size_t idx = 0; idx < size; idx++)
+        contents[idx] = static_cast<char>(idx * 2654435761U >> 13);
+
+    Throughput("DedupStore::Hash (4 MiB)", size, 256, [&]()
+               { DedupStore::Hash(contents.data(), size); });
+
+    // per-user copies of the same defaults
+    const int user_count = 64;
+    dedup_store_ptr store = DedupStore::Create();
+    std::vector<partition_ptr> partitions{};
+    std::vector<file_ptr> files{};
+
+    Bench(std::format("Write + dedup 4 MiB file x{}", user_count), user_count, [&]()
+          {
+              partition_ptr part = Partition::Create();
+              part->SetDedupStore(store);
+              file_ptr file = RegularFile::Create();
+              file->write(0, contents.data(), size);
+              part->Deduplicate(file);
+              partitions.push_back(part);
+              files.push_back(file); });
+
+    DedupStore::Stats stats = store->GetStats();
+    Log("{} MiB referenced, {} MiB stored", stats.shared_pages * RegularFile::PAGE_SIZE >> 20, stats.unique_pages * RegularFile::PAGE_SIZE >> 20);
+}
+
+//
+// Vectored I/O
+//
+
+void BenchVectored(void)
+{
+    Log("<<<< VECTORED I/O >>>>");
+
+    QFS qfs;
+    int fd = qfs.Operation.Open("/scatter", QUASI_O_CREAT | QUASI_O_RDWR);
+
+    // packet-like record: small header, payload, small trailer, repeated
+    const int buffer_count = 16;
+    std::vector<std::vector<char>> buffers{};
+    std::vector<quasi_iovec_t> iov{};
+    for (int idx = 0; idx < buffer_count; idx++)
+    {
+        buffers.emplace_back(idx % 2 ? 512 : 32, 'v');
+        iov.push_back({buffers.back().data(), buffers.back().size()});
+    }
+
+    Bench(std::format("Operation.PWrite x{}", buffer_count), 100000, [&]()
+          {
+              quasi_off_t pos = 0;
+              for (const quasi_iovec_t &vec : iov)
+                  pos += qfs.Operation.PWrite(fd, vec.iov_base, vec.iov_len, pos); });
+
+    Bench(std::format("Operation.PWriteV ({} buffers)", buffer_count), 100000, [&]()
+          { qfs.Operation.PWriteV(fd, iov.data(), buffer_count, 0); });
+
+    Bench(std::format("Operation.PRead x{}", buffer_count), 100000, [&]()
+          {
+              quasi_off_t pos = 0;
+              for (const quasi_iovec_t &vec : iov)
+                  pos += qfs.Operation.PRead(fd, vec.iov_base, vec.iov_len, pos); });
+
+    Bench(std::format("Operation.PReadV ({} buffers)", buffer_count), 100000, [&]()
+          { qfs.Operation.PReadV(fd, iov.data(), buffer_count, 0); });
+
+    qfs.Operation.Close(fd);
+}
+
+//
+// File descriptors
+//
+
+void BenchDescriptors(void)
+{
+    Log("<<<< FILE DESCRIPTORS >>>>");
+
+    QFS qfs;
+    qfs.Operation.Close(qfs.Operation.Creat("/churn"));
+
+    const int fd_count = 100000;
+    std::vector<int> fds{};
+    fds.reserve(fd_count);
+
+    Bench(std::format("Operation.Open ({} fds)", fd_count), fd_count, [&]()
+          { fds.push_back(qfs.Operation.Open("/churn", QUASI_O_RDONLY)); });
+
+    // punch holes all over the table, every Open has to find the lowest one
+    Bench(std::format("Operation.Close + Open ({} held)", fd_count), fd_count, [&, idx = 0]() mutable
+          {
+              int &fd = fds[idx++ * 7919 % fd_count];
+              qfs.Operation.Close(fd);
+              fd = qfs.Operation.Open("/churn", QUASI_O_RDONLY); });
+
+    Bench(std::format("Operation.Close ({} fds)", fd_count), fd_count, [&, idx = 0]() mutable
+          { qfs.Operation.Close(fds[idx++ * 7919 % fd_count]); });
+
+    // handle lookup dominates when there's barely any data to move
+    int fd = qfs.Operation.Open("/churn", QUASI_O_RDWR);
+    char buffer[16]{};
+    qfs.Operation.PWrite(fd, buffer, sizeof(buffer), 0);
+
+    Bench("Operation.PRead (16 B)", 10000000, [&]()
+          { qfs.Operation.PRead(fd, buffer, sizeof(buffer), 0); });
+    Bench("Operation.PWrite (16 B)", 10000000, [&]()
+          { qfs.Operation.PWrite(fd, buffer, sizeof(buffer), 0); });
+    Bench("Operation.LSeek", 10000000, [&]()
+          { qfs.Operation.LSeek(fd, 0, SeekOrigin::ORIGIN); });
+
+    qfs.Operation.Close(fd);
+}
+
+int main()
+{
+    BenchResolve();
+    BenchResolveMany();
+    BenchDirectory();
+    BenchInodeTable();
+    BenchFileIO();
+    BenchTinyFiles();
+    BenchCompression();
+    BenchDedup();
+    BenchVectored();
+    BenchDescriptors();
+
+    return 0;
+}
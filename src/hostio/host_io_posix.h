@@ -37,6 +37,10 @@ namespace HostIODriver
                 return SEEK_CUR;
             case QuasiFS::SeekOrigin::END:
                 return SEEK_END;
+            case QuasiFS::SeekOrigin::DATA:
+                return SEEK_DATA;
+            case QuasiFS::SeekOrigin::HOLE:
+                return SEEK_HOLE;
             default:
                 return -1;
             }
@@ -45,54 +49,62 @@ namespace HostIODriver
         static constexpr int ToPOSIXOpenFlags(int quasi_flags)
         {
             int flags = 0;
-            if (quasi_flags | QUASI_O_ACCMODE)
-                flags |= O_ACCMODE;
-            if (quasi_flags | QUASI_O_RDONLY)
+
+            // access mode is a value, not a set of bits (O_RDONLY is 0)
+            switch (quasi_flags & QUASI_O_ACCMODE)
+            {
+            case QUASI_O_RDONLY:
                 flags |= O_RDONLY;
-            if (quasi_flags | QUASI_O_WRONLY)
+                break;
+            case QUASI_O_WRONLY:
                 flags |= O_WRONLY;
-            if (quasi_flags | QUASI_O_RDWR)
+                break;
+            case QUASI_O_RDWR:
                 flags |= O_RDWR;
-            if (quasi_flags | QUASI_O_CREAT)
+                break;
+            default:
+                flags |= O_ACCMODE;
+                break;
+            }
+
+            // some flags are made of several bits (O_SYNC includes O_DSYNC, O_TMPFILE includes O_DIRECTORY)
+            auto has = [quasi_flags](int quasi_flag)
+            { return (quasi_flags & quasi_flag) == quasi_flag; };
+
+            if (has(QUASI_O_CREAT))
                 flags |= O_CREAT;
-            if (quasi_flags | QUASI_O_EXCL)
+            if (has(QUASI_O_EXCL))
                 flags |= O_EXCL;
-            if (quasi_flags | QUASI_O_NOCTTY)
+            if (has(QUASI_O_NOCTTY))
                 flags |= O_NOCTTY;
-            if (quasi_flags | QUASI_O_TRUNC)
+            if (has(QUASI_O_TRUNC))
                 flags |= O_TRUNC;
-            if (quasi_flags | QUASI_O_APPEND)
+            if (has(QUASI_O_APPEND))
                 flags |= O_APPEND;
-            if (quasi_flags | QUASI_O_NONBLOCK)
+            if (has(QUASI_O_NONBLOCK))
                 flags |= O_NONBLOCK;
-            if (quasi_flags | QUASI_O_NDELAY)
-                flags |= O_NDELAY;
-            if (quasi_flags | QUASI_O_SYNC)
+            if (has(QUASI_O_SYNC))
                 flags |= O_SYNC;
-            if (quasi_flags | QUASI_O_FSYNC)
-                flags |= O_FSYNC;
-            if (quasi_flags | QUASI_O_ASYNC)
+            if (has(QUASI_O_ASYNC))
                 flags |= O_ASYNC;
-            if (quasi_flags | QUASI_O_LARGEFILE)
+            if (has(QUASI_O_LARGEFILE))
                 flags |= O_LARGEFILE;
-            if (quasi_flags | QUASI_O_DIRECTORY)
+            if (has(QUASI_O_DIRECTORY))
                 flags |= O_DIRECTORY;
-            if (quasi_flags | QUASI_O_NOFOLLOW)
+            if (has(QUASI_O_NOFOLLOW))
                 flags |= O_NOFOLLOW;
-            if (quasi_flags | QUASI_O_CLOEXEC)
+            if (has(QUASI_O_CLOEXEC))
                 flags |= O_CLOEXEC;
-            if (quasi_flags | QUASI_O_DIRECT)
+            if (has(QUASI_O_DIRECT))
                 flags |= O_DIRECT;
-            if (quasi_flags | QUASI_O_NOATIME)
+            if (has(QUASI_O_NOATIME))
                 flags |= O_NOATIME;
-            if (quasi_flags | QUASI_O_PATH)
+            if (has(QUASI_O_PATH))
                 flags |= O_PATH;
-            if (quasi_flags | QUASI_O_TMPFILE)
+            if (has(QUASI_O_TMPFILE))
                 flags |= O_TMPFILE;
-            if (quasi_flags | QUASI_O_DSYNC)
+            if (has(QUASI_O_DSYNC))
                 flags |= O_DSYNC;
-            if (quasi_flags | QUASI_O_RSYNC)
-                flags |= O_RSYNC;
 
             return flags;
         }
@@ -128,6 +140,10 @@ namespace HostIODriver
         quasi_ssize_t PWrite(const int fd, const void *buf, quasi_size_t count, quasi_off_t offset) override;
         quasi_ssize_t Read(const int fd, void *buf, quasi_size_t count) override;
         quasi_ssize_t PRead(const int fd, void *buf, quasi_size_t count, quasi_off_t offset) override;
+        quasi_ssize_t WriteV(const int fd, const quasi_iovec_t *iov, int iovcnt) override;
+        quasi_ssize_t PWriteV(const int fd, const quasi_iovec_t *iov, int iovcnt, quasi_off_t offset) override;
+        quasi_ssize_t ReadV(const int fd, const quasi_iovec_t *iov, int iovcnt) override;
+        quasi_ssize_t PReadV(const int fd, const quasi_iovec_t *iov, int iovcnt, quasi_off_t offset) override;
         int MKDir(const fs::path &path, quasi_mode_t mode = 0755) override;
         int RMDir(const fs::path &path) override;
 
@@ -27,6 +27,11 @@ namespace HostIODriver
     quasi_ssize_t HostIO_Base::PWrite(const int fd, const void *buf, quasi_size_t count, quasi_off_t offset) { STUB(); }
     quasi_ssize_t HostIO_Base::Read(const int fd, void *buf, quasi_size_t count) { STUB(); }
     quasi_ssize_t HostIO_Base::PRead(const int fd, void *buf, quasi_size_t count, quasi_off_t offset) { STUB(); }
+    quasi_ssize_t HostIO_Base::WriteV(const int fd, const quasi_iovec_t *iov, int iovcnt) { STUB(); }
+    quasi_ssize_t HostIO_Base::PWriteV(const int fd, const quasi_iovec_t *iov, int iovcnt, quasi_off_t offset) { STUB(); }
+    quasi_ssize_t HostIO_Base::ReadV(const int fd, const quasi_iovec_t *iov, int iovcnt) { STUB(); }
+    quasi_ssize_t HostIO_Base::PReadV(const int fd, const quasi_iovec_t *iov, int iovcnt, quasi_off_t offset) { STUB(); }
+    quasi_ssize_t HostIO_Base::GetDents(const int fd, void *buf, quasi_size_t nbytes) { STUB(); }
     int HostIO_Base::MKDir(const fs::path &path, quasi_mode_t mode) { STUB(); }
     int HostIO_Base::RMDir(const fs::path &path) { STUB(); }
     int HostIO_Base::Stat(const fs::path &path, quasi_stat_t *statbuf) { STUB(); }
@@ -45,6 +45,11 @@ namespace HostIODriver
         virtual quasi_ssize_t PWrite(const int fd, const void *buf, quasi_size_t count, quasi_off_t offset);
         virtual quasi_ssize_t Read(const int fd, void *buf, quasi_size_t count);
         virtual quasi_ssize_t PRead(const int fd, void *buf, quasi_size_t count, quasi_off_t offset);
+        virtual quasi_ssize_t WriteV(const int fd, const quasi_iovec_t *iov, int iovcnt);
+        virtual quasi_ssize_t PWriteV(const int fd, const quasi_iovec_t *iov, int iovcnt, quasi_off_t offset);
+        virtual quasi_ssize_t ReadV(const int fd, const quasi_iovec_t *iov, int iovcnt);
+        virtual quasi_ssize_t PReadV(const int fd, const quasi_iovec_t *iov, int iovcnt, quasi_off_t offset);
+        virtual quasi_ssize_t GetDents(const int fd, void *buf, quasi_size_t nbytes);
         virtual int MKDir(const fs::path &path, quasi_mode_t mode = 0755);
         virtual int RMDir(const fs::path &path);
 
@@ -7,6 +7,7 @@
 #include <sys/unistd.h>
 #include <sys/fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 
 #include "../../quasifs/quasi_errno.h"
 #include "../../quasifs/quasi_types.h"
@@ -95,7 +96,7 @@ namespace HostIODriver
     quasi_off_t HostIO_POSIX::LSeek(const int fd, quasi_off_t offset, QuasiFS::SeekOrigin origin)
     {
         errno = 0;
-        int status = lseek(fd, offset, ToPOSIXSeekOrigin(origin));
+        quasi_off_t status = lseek(fd, offset, ToPOSIXSeekOrigin(origin));
         return status >= 0 ? status : -errno;
     }
 
@@ -107,28 +108,59 @@ namespace HostIODriver
     quasi_ssize_t HostIO_POSIX::Write(const int fd, const void *buf, quasi_size_t count)
     {
         errno = 0;
-        int status = write(fd, buf, count);
+        quasi_ssize_t status = write(fd, buf, count);
         return status >= 0 ? status : -errno;
     }
 
     quasi_ssize_t HostIO_POSIX::PWrite(const int fd, const void *buf, quasi_size_t count, quasi_off_t offset)
     {
         errno = 0;
-        int status = pwrite(fd, buf, count, offset);
+        quasi_ssize_t status = pwrite(fd, buf, count, offset);
         return status >= 0 ? status : -errno;
     }
 
     quasi_ssize_t HostIO_POSIX::Read(const int fd, void *buf, quasi_size_t count)
     {
         errno = 0;
-        int status = read(fd, buf, count);
+        quasi_ssize_t status = read(fd, buf, count);
         return status >= 0 ? status : -errno;
     }
 
     quasi_ssize_t HostIO_POSIX::PRead(const int fd, void *buf, quasi_size_t count, quasi_off_t offset)
     {
         errno = 0;
-        int status = pread(fd, buf, count, offset);
+        quasi_ssize_t status = pread(fd, buf, count, offset);
+        return status >= 0 ? status : -errno;
+    }
+
+    static_assert(sizeof(quasi_iovec_t) == sizeof(iovec) && offsetof(quasi_iovec_t, iov_len) == offsetof(iovec, iov_len),
+                  "quasi_iovec_t must be passable to host as struct iovec");
+
+    quasi_ssize_t HostIO_POSIX::WriteV(const int fd, const quasi_iovec_t *iov, int iovcnt)
+    {
+        errno = 0;
+        quasi_ssize_t status = writev(fd, reinterpret_cast<const iovec *>(iov), iovcnt);
+        return status >= 0 ? status : -errno;
+    }
+
+    quasi_ssize_t HostIO_POSIX::PWriteV(const int fd, const quasi_iovec_t *iov, int iovcnt, quasi_off_t offset)
+    {
+        errno = 0;
+        quasi_ssize_t status = pwritev(fd, reinterpret_cast<const iovec *>(iov), iovcnt, offset);
+        return status >= 0 ? status : -errno;
+    }
+
+    quasi_ssize_t HostIO_POSIX::ReadV(const int fd, const quasi_iovec_t *iov, int iovcnt)
+    {
+        errno = 0;
+        quasi_ssize_t status = readv(fd, reinterpret_cast<const iovec *>(iov), iovcnt);
+        return status >= 0 ? status : -errno;
+    }
+
+    quasi_ssize_t HostIO_POSIX::PReadV(const int fd, const quasi_iovec_t *iov, int iovcnt, quasi_off_t offset)
+    {
+        errno = 0;
+        quasi_ssize_t status = preadv(fd, reinterpret_cast<const iovec *>(iov), iovcnt, offset);
         return status >= 0 ? status : -errno;
     }
 
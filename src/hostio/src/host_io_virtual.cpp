@@ -44,7 +44,7 @@ namespace HostIODriver
             if ((flags & QUASI_O_CREAT) == 0)
                 return -QUASI_ENOENT;
 
-            target = RegularFile::Create();
+            target = part->NewInode<RegularFile>();
             target->chmod(mode);
             if (0 != part->touch(parent, this->res->leaf, target))
                 // touch failed in target directory, issue with resolve() most likely
@@ -89,7 +89,7 @@ namespace HostIODriver
             return -QUASI_ENOTDIR;
 
         dir_ptr parent = std::static_pointer_cast<Directory>(this->res->node);
-        file_ptr new_file = RegularFile::Create();
+        file_ptr new_file = this->res->mountpoint->NewInode<RegularFile>();
         return this->res->mountpoint->touch(parent, path.filename(), new_file);
     }
 
@@ -104,7 +104,7 @@ namespace HostIODriver
         if (nullptr == this->res)
             return -QUASI_EINVAL;
 
-        symlink_ptr sym = Symlink::Create(src);
+        symlink_ptr sym = this->res->mountpoint->NewInode<Symlink>(src);
         // symlink counter is never increased
         sym->st.st_nlink = 1;
 
@@ -159,7 +159,7 @@ namespace HostIODriver
         if (nullptr == handle)
             return -QUASI_EINVAL;
 
-        inode_ptr node = handle->node;
+        const inode_ptr &node = handle->node;
 
         if (nullptr == node)
             return -QUASI_EBADF;
@@ -194,7 +194,7 @@ namespace HostIODriver
         if (nullptr == handle)
             return -QUASI_EINVAL;
 
-        inode_ptr node = handle->node;
+        const inode_ptr &node = handle->node;
 
         if (nullptr == node)
             return -QUASI_EBADF;
@@ -216,13 +216,27 @@ namespace HostIODriver
         if (nullptr == handle)
             return -QUASI_EINVAL;
 
-        inode_ptr node = handle->node;
+        const inode_ptr &node = handle->node;
 
         if (nullptr == node)
             return -QUASI_EBADF;
 
         auto ptr = &handle->pos;
 
+        if (SeekOrigin::DATA == origin || SeekOrigin::HOLE == origin)
+        {
+            if (!node->is_file())
+                return -QUASI_EINVAL;
+
+            // host-bound files don't keep pages, caller passes host's answer as ORIGIN instead
+            quasi_off_t new_ptr = node->lseek(offset, origin);
+            if (new_ptr < 0)
+                return new_ptr;
+
+            *ptr = new_ptr;
+            return *ptr;
+        }
+
         quasi_off_t new_ptr =
             (SeekOrigin::ORIGIN == origin) * offset +
             (SeekOrigin::CURRENT == origin) * (*(ptr) + offset) +
@@ -242,7 +256,7 @@ namespace HostIODriver
 
     quasi_ssize_t HostIO_Virtual::Write(const int fd, const void *buf, quasi_size_t count)
     {
-        ssize_t bw = this->PWrite(fd, buf, count, handle->pos);
+        quasi_ssize_t bw = this->PWrite(fd, buf, count, handle->pos);
 
         if (bw > 0)
             handle->pos += bw;
@@ -255,7 +269,7 @@ namespace HostIODriver
         if (nullptr == handle)
             return -QUASI_EBADF;
 
-        inode_ptr node = handle->node;
+        const inode_ptr &node = handle->node;
 
         if (nullptr == node)
             return -QUASI_EBADF;
@@ -263,7 +277,7 @@ namespace HostIODriver
         if (handle->append)
             offset = node->st.st_size;
 
-        ssize_t bw = 0;
+        quasi_ssize_t bw = 0;
 
         if (this->host_bound && node->is_file())
         {
@@ -277,7 +291,7 @@ namespace HostIODriver
 
     quasi_ssize_t HostIO_Virtual::Read(const int fd, void *buf, quasi_size_t count)
     {
-        ssize_t br = PRead(fd, buf, count, handle->pos);
+        quasi_ssize_t br = PRead(fd, buf, count, handle->pos);
 
         if (br > 0)
             handle->pos += br;
@@ -290,7 +304,7 @@ namespace HostIODriver
         if (nullptr == handle)
             return -QUASI_EINVAL;
 
-        inode_ptr node = handle->node;
+        const inode_ptr &node = handle->node;
 
         if (nullptr == node)
             return -QUASI_EBADF;
@@ -301,12 +315,95 @@ namespace HostIODriver
         return node->read(offset, buf, count);
     }
 
+    quasi_ssize_t HostIO_Virtual::WriteV(const int fd, const quasi_iovec_t *iov, int iovcnt)
+    {
+        quasi_ssize_t bw = PWriteV(fd, iov, iovcnt, handle->pos);
+
+        if (bw > 0)
+            handle->pos += bw;
+
+        return bw;
+    }
+
+    quasi_ssize_t HostIO_Virtual::PWriteV(const int fd, const quasi_iovec_t *iov, int iovcnt, quasi_off_t offset)
+    {
+        if (nullptr == handle)
+            return -QUASI_EBADF;
+
+        const inode_ptr &node = handle->node;
+
+        if (nullptr == node)
+            return -QUASI_EBADF;
+
+        if (handle->append)
+            offset = node->st.st_size;
+
+        if (this->host_bound && node->is_file())
+        {
+            // no data to scatter, only size matters
+            quasi_size_t count = 0;
+            for (int idx = 0; idx < iovcnt; idx++)
+                count += iov[idx].iov_len;
+            return std::static_pointer_cast<RegularFile>(node)->MockWrite(offset, nullptr, count);
+        }
+
+        return node->writev(offset, iov, iovcnt);
+    }
+
+    quasi_ssize_t HostIO_Virtual::ReadV(const int fd, const quasi_iovec_t *iov, int iovcnt)
+    {
+        quasi_ssize_t br = PReadV(fd, iov, iovcnt, handle->pos);
+
+        if (br > 0)
+            handle->pos += br;
+
+        return br;
+    }
+
+    quasi_ssize_t HostIO_Virtual::PReadV(const int fd, const quasi_iovec_t *iov, int iovcnt, quasi_off_t offset)
+    {
+        if (nullptr == handle)
+            return -QUASI_EINVAL;
+
+        const inode_ptr &node = handle->node;
+
+        if (nullptr == node)
+            return -QUASI_EBADF;
+
+        if (this->host_bound && node->is_file())
+        {
+            quasi_size_t count = 0;
+            for (int idx = 0; idx < iovcnt; idx++)
+                count += iov[idx].iov_len;
+            return std::static_pointer_cast<RegularFile>(node)->MockRead(offset, nullptr, count);
+        }
+
+        return node->readv(offset, iov, iovcnt);
+    }
+
+    quasi_ssize_t HostIO_Virtual::GetDents(const int fd, void *buf, quasi_size_t nbytes)
+    {
+        if (nullptr == handle)
+            return -QUASI_EINVAL;
+
+        const inode_ptr &node = handle->node;
+
+        if (nullptr == node)
+            return -QUASI_EBADF;
+
+        if (!node->is_dir())
+            return -QUASI_ENOTDIR;
+
+        // directory stream position lives in the same place as file cursor
+        return node->getdents(buf, nbytes, &handle->pos);
+    }
+
     int HostIO_Virtual::MKDir(const fs::path &path, quasi_mode_t mode)
     {
         if (nullptr == this->res)
             return -QUASI_EINVAL;
 
-        dir_ptr new_dir = Directory::Create();
+        dir_ptr new_dir = this->res->mountpoint->NewInode<Directory>();
         return this->res->mountpoint->mkdir(this->res->parent, this->res->leaf, new_dir);
     }
 
@@ -356,7 +453,7 @@ namespace HostIODriver
         if (nullptr == this->handle)
             return -QUASI_EINVAL;
 
-        inode_ptr node = this->handle->node;
+        const inode_ptr &node = this->handle->node;
 
         if (nullptr == node)
             return -QUASI_EBADF;
@@ -384,7 +481,7 @@ namespace HostIODriver
         if (nullptr == this->handle)
             return -QUASI_EINVAL;
 
-        inode_ptr node = this->handle->node;
+        const inode_ptr &node = this->handle->node;
 
         if (nullptr == node)
             return -QUASI_EBADF;
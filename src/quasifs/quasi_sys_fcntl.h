@@ -12,9 +12,9 @@
 #define QUASI_O_TRUNC 01000 /* Not fcntl.  */
 #define QUASI_O_APPEND 02000
 #define QUASI_O_NONBLOCK 04000
-#define QUASI_O_NDELAY O_NONBLOCK
+#define QUASI_O_NDELAY QUASI_O_NONBLOCK
 #define QUASI_O_SYNC 04010000
-#define QUASI_O_FSYNC O_SYNC
+#define QUASI_O_FSYNC QUASI_O_SYNC
 #define QUASI_O_ASYNC 020000
 #define __O_LARGEFILE 0100000
 
@@ -38,4 +38,6 @@
 #define QUASI_O_TMPFILE __O_TMPFILE /* Atomically create nameless file.  */
 
 #define QUASI_O_DSYNC __O_DSYNC /* Synchronize data.  */
-#define QUASI_O_RSYNC O_SYNC    /* Synchronize read operations.  */
\ No newline at end of file
+#define QUASI_O_RSYNC QUASI_O_SYNC    /* Synchronize read operations.  */
+
+#define QUASI_AT_FDCWD -100 /* Use current working directory.  */
\ No newline at end of file
@@ -0,0 +1,7 @@
+// INAA License @marecl 2025
+
+#pragma once
+
+#define QUASI_PROT_NONE 0x0  /* Page can not be accessed.  */
+#define QUASI_PROT_READ 0x1  /* Page can be read.  */
+#define QUASI_PROT_WRITE 0x2 /* Page can be written.  */
@@ -23,11 +23,12 @@ namespace QuasiFS
     // POSIX-port
     using quasi_errno_t = int;
     using quasi_mode_t = int;
-    using quasi_off_t = signed int;
+    // offsets and sizes are 64-bit everywhere, regardless of host's long
+    using quasi_off_t = int64_t;
     using quasi_off64_t = int64_t;
     using quasi_lquasi_off_t = int64_t;
-    using quasi_ssize_t = long;
-    using quasi_size_t = unsigned long;
+    using quasi_ssize_t = int64_t;
+    using quasi_size_t = uint64_t;
 
     using quasi_dev_t = int;
     using quasi_ino_t = int;
@@ -46,6 +47,8 @@ namespace QuasiFS
     using dir_ptr = std::shared_ptr<Directory>;
     class Device;
     using dev_ptr = std::shared_ptr<Device>;
+    class DedupStore;
+    using dedup_store_ptr = std::shared_ptr<DedupStore>;
 
     // resolve path into (parent_dir, leaf_name, inode)
     struct Resolved
@@ -57,31 +60,45 @@ namespace QuasiFS
         std::string leaf{};         // leaf - name
     };
 
+    // idle file compression counters, one set per partition (see Partition::SetCompression)
+    struct CompressionStats
+    {
+        uint64_t pages_packed{0};   // pages compressed so far
+        uint64_t pages_unpacked{0}; // pages decompressed so far
+        uint64_t original_bytes{0}; // pages currently compressed, before compression
+        uint64_t packed_bytes{0};   // pages currently compressed, after compression
+        uint64_t unpack_ns{0};      // total time spent decompressing
+        uint64_t unpack_max_ns{0};  // slowest single page
+
+        double Ratio(void) const { return 0 == packed_bytes ? 1.0 : static_cast<double>(original_bytes) / packed_bytes; }
+        double AverageUnpackNs(void) const { return 0 == pages_unpacked ? 0.0 : static_cast<double>(unpack_ns) / pages_unpacked; }
+    };
+    using compression_stats_ptr = std::shared_ptr<CompressionStats>;
+
     typedef struct File File;
-    using fd_handle_ptr = std::shared_ptr<File>;
+    // borrowed, File lives in QFS fd table and is valid until its fd is closed
+    using fd_handle_ptr = File *;
 
+    // open file description, free when node is unset
     struct File
     {
         File() = default;
         ~File() = default;
         int host_fd{-1};         // fd if opened with HostIO
         inode_ptr node{nullptr}; // inode
+        partition_ptr mountpoint{nullptr}; // partition owning the inode
+        fs::path local_path{};   // partition's local path, used as a base for *At() calls
         bool read{false};        // read permission
         bool write{false};       // write permission
         bool append{false};      // append
         quasi_off_t pos{0};      // cursor offset
 
-        static fd_handle_ptr Create()
-        {
-            return std::shared_ptr<File>(new File());
-        }
-
-        bool IsOpen(void)
+        bool IsOpen(void) const
         {
             return nullptr != this->node;
         }
 
-        bool IsHostBound(void)
+        bool IsHostBound(void) const
         {
             return -1 != host_fd;
         }
@@ -98,11 +115,25 @@ namespace QuasiFS
     } dirent_t;
 #pragma pack(pop)
 
+    // layout-compatible with struct iovec (man(2) readv)
+    typedef struct quasi_iovec_t
+    {
+        void *iov_base{};
+        quasi_size_t iov_len{};
+    } quasi_iovec_t;
+
+    // same as Linux' UIO_MAXIOV
+    constexpr int QUASI_IOV_MAX = 1024;
+
     enum class SeekOrigin : uint8_t
     {
         ORIGIN,
         CURRENT,
-        END
+        END,
+        // next non-hole offset at or after [offset]
+        DATA,
+        // next hole at or after [offset], EOF is treated as a hole
+        HOLE
     };
 
     //
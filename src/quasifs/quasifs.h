@@ -2,13 +2,20 @@
 
 #pragma once
 
+#include <deque>
+#include <functional>
+#include <queue>
+#include <span>
+#include <string_view>
 #include <unordered_map>
 
 #include "quasi_sys_stat.h"
 #include "quasi_types.h"
+#include "quasifs_dentry_cache.h"
 #include "quasifs_inode.h"
 #include "quasifs_inode_directory.h"
 #include "quasifs_inode_symlink.h"
+#include "quasifs_mapping.h"
 
 #include "../hostio/host_io.h"
 
@@ -41,8 +48,19 @@ namespace QuasiFS
         // this will make a lot of sense when using RO filesystem opt
         std::unordered_map<partition_ptr, mount_t> block_devices{};
 
-        // open file descriptors. search is linear, looking for first available nullptr
-        std::vector<fd_handle_ptr> open_fd;
+        // open file descriptions stored in place, indexed by fd, closed File marks a free slot
+        // slots are reused, so steady open/close doesn't allocate handles
+        // deque never moves existing slots when growing or trimming, borrowed handles stay valid
+        std::deque<File> open_fd;
+        // min-heap of freed slots, lowest one is handed out first (POSIX)
+        // entries are dropped lazily, slot may have been reused or trimmed off the table since
+        std::priority_queue<size_t, std::vector<size_t>, std::greater<size_t>> free_fd{};
+
+        // path -> Resolved, skips full walk for paths that were already resolved
+        DentryCache dentry_cache{};
+
+        // symlink target is being resolved by a nested walk
+        bool following_symlink{false};
 
         HostIO hio_driver{};
         HostVIO vio_driver{};
@@ -77,6 +95,11 @@ namespace QuasiFS
             quasi_ssize_t PWrite(const int fd, const void *buf, quasi_size_t count, quasi_off_t offset) override;
             quasi_ssize_t Read(const int fd, void *buf, quasi_size_t count) override;
             quasi_ssize_t PRead(const int fd, void *buf, quasi_size_t count, quasi_off_t offset) override;
+            quasi_ssize_t WriteV(const int fd, const quasi_iovec_t *iov, int iovcnt) override;
+            quasi_ssize_t PWriteV(const int fd, const quasi_iovec_t *iov, int iovcnt, quasi_off_t offset) override;
+            quasi_ssize_t ReadV(const int fd, const quasi_iovec_t *iov, int iovcnt) override;
+            quasi_ssize_t PReadV(const int fd, const quasi_iovec_t *iov, int iovcnt, quasi_off_t offset) override;
+            quasi_ssize_t GetDents(const int fd, void *buf, quasi_size_t nbytes) override;
             int MKDir(const fs::path &path, quasi_mode_t mode = 0755) override;
             int RMDir(const fs::path &path) override;
 
@@ -85,6 +108,26 @@ namespace QuasiFS
 
             int Chmod(const fs::path &path, quasi_mode_t mode) override;
             int FChmod(const int fd, quasi_mode_t mode) override;
+
+            //
+            // Directory-relative variants (man(2) openat)
+            // Relative paths are resolved from directory opened as [dirfd], without walking its path again
+            // QUASI_AT_FDCWD behaves exactly like the base variant
+            //
+
+            int OpenAt(const int dirfd, const fs::path &path, int flags, quasi_mode_t mode = 0755);
+            int LinkAt(const int src_dirfd, const fs::path &src, const int dst_dirfd, const fs::path &dst);
+            int UnlinkAt(const int dirfd, const fs::path &path);
+            int MKDirAt(const int dirfd, const fs::path &path, quasi_mode_t mode = 0755);
+            int StatAt(const int dirfd, const fs::path &path, quasi_stat_t *statbuf);
+
+            //
+            // Clone contents of [src_fd] into [dst_fd] (man(2) ioctl_ficlone)
+            // Data pages are shared and copied on write, so this costs only the page table
+            // Both must be regular files on the same partition, [dst_fd] must be writable
+            //
+
+            int Clone(const int src_fd, const int dst_fd);
         };
 
     public:
@@ -141,8 +184,18 @@ namespace QuasiFS
          *      * mountpoint - mountpoint (no change)
          *      * parent - holding dir that is a mountpoint (/dir/INODE->mounted_dir)
          *      * node - node holding mounted root (/dir/inode->MOUNTED_DIR)
+         *  7. Successful resolutions are cached, until any mutation bumps dentry generation
+         *     Missing last element is cached too, until that name is linked into the parent
          */
         int Resolve(const fs::path &path, Resolved &res);
+        // Same as above, but relative [path] is resolved from directory opened as [dirfd]
+        // QUASI_AT_FDCWD or absolute [path] fall back to regular Resolve()
+        int ResolveAt(const int dirfd, const fs::path &path, Resolved &res);
+        // Resolve a batch of absolute paths, every shared directory prefix is walked only once
+        // [res] (and [status] if not empty) must be at least as big as [paths]
+        // Results are the same as Resolve() called on each path, returns number of successful resolutions
+        // Dentry cache is consulted, but not filled
+        int ResolveMany(std::span<const fs::path> paths, std::span<Resolved> res, std::span<int> status = {});
 
         int GetHostPath(fs::path &output, const fs::path &path = "/");
 
@@ -153,8 +206,13 @@ namespace QuasiFS
         bool IsOpen(const int fd) noexcept;
         int SetSize(const int fd, uint64_t size) noexcept;
         quasi_ssize_t GetSize(const int fd) noexcept;
-        // Not a port, used by 2-3 functions that ;
+        // Not a port. Size of dirent_t records of this directory only (enough to getdents() it in one go),
+        // not a total of the subtree
         quasi_ssize_t GetDirectorySize(const fs::path &path) noexcept;
+        // Zero-copy access to file opened as [fd] (man(2) mmap, always MAP_SHARED)
+        // [prot] is QUASI_PROT_READ and/or QUASI_PROT_WRITE, range must be within the file
+        // Host-bound files can't be mapped (ENODEV), their data isn't kept in memory
+        int Map(const int fd, quasi_off_t offset, quasi_size_t length, int prot, FileMapping &mapping) noexcept;
 
         //
         // FS operations
@@ -199,13 +257,36 @@ namespace QuasiFS
 
     private:
         void SyncHostImpl(partition_ptr part);
+        // symlinks and mount crossings a single walk may take before ELOOP
+        static constexpr uint8_t MAX_RESOLVE_HOPS = 40;
+        // uncached path walk, starts at [start] directory if set
+        // [hops_left] carries hop budget between walks that continue one another, updated on return
+        int ResolveImpl(std::string_view path, Resolved &res, fd_handle_ptr start = nullptr, uint8_t *hops_left = nullptr);
+        // resolve symlink's target, reusing (and refreshing) the one cached in the symlink
+        // [local_path] views target's local path, valid as long as [link] is alive
+        // false if target can't be resolved, path has to be spliced then
+        bool FollowSymlink(const symlink_ptr &link, Resolved &res, std::string_view &local_path);
+        // directory state of a prefix and hops its walk has left, so split walks loop out like a full one
+        struct PrefixState
+        {
+            File dir{};
+            uint8_t hops_left{MAX_RESOLVE_HOPS};
+        };
+        // directory prefix -> directory state (nullptr if it didn't resolve to a directory)
+        using prefix_memo_t = std::unordered_map<std::string_view, PrefixState>;
+        PrefixState *ResolvePrefix(prefix_memo_t &memo, std::string_view prefix);
 
-        // Get next available fd slot
+        // Get lowest available fd slot
         int GetFreeHandleNo();
+        // Free [fd] slot, table is trimmed if it was the last one
+        void ReleaseHandleNo(int fd);
+        // Borrowed handle to open [fd], nullptr if it isn't open
+        // valid until [fd] is closed, don't keep it past the current operation
         fd_handle_ptr GetHandle(int fd);
         // partition by blkdev
         //  partition_ptr GetPartitionByBlockdev(uint64_t blkid);
         mount_t *GetPartitionInfo(const partition_ptr part);
+        // exact match with the path partition was mounted at, no resolution (symlinks, "..", trailing /)
         partition_ptr GetPartitionByPath(const fs::path &path);
         partition_ptr GetPartitionByParent(const dir_ptr dir);
         int IsPartitionRO(const partition_ptr part);
@@ -0,0 +1,57 @@
+// INAA License @marecl 2025
+
+#pragma once
+
+#include <unordered_map>
+
+#include "quasi_types.h"
+#include "quasifs_inode_regularfile.h"
+
+namespace QuasiFS
+{
+
+    /**
+     * Content-addressed page index, may be shared by any number of partitions (Partition::SetDedupStore)
+     * Pages are keyed by a hash of their contents, identical pages are shared the same way clone() does it,
+     * so modification goes through regular copy-on-write.
+     *
+     * Store doesn't own pages, it only knows where they are. Pages are compared byte by byte before sharing,
+     * so hash collisions and pages modified in place after being indexed never cause wrong sharing.
+     * Dead entries are dropped lazily.
+     */
+    class DedupStore
+    {
+        std::unordered_multimap<uint64_t, std::weak_ptr<RegularFile::Page>> index{};
+        // index is pruned when it doubles since last prune
+        size_t prune_threshold{1024};
+
+        uint64_t lookups{0};
+        uint64_t hits{0};
+
+    public:
+        struct Stats
+        {
+            uint64_t lookups{0};        // pages looked up so far
+            uint64_t hits{0};           // pages replaced with one already indexed
+            uint64_t unique_pages{0};   // live indexed pages
+            uint64_t shared_pages{0};   // references to live indexed pages, unique_pages if nothing is shared
+        };
+
+        DedupStore() = default;
+        ~DedupStore() = default;
+
+        static dedup_store_ptr Create(void)
+        {
+            return std::make_shared<DedupStore>();
+        }
+
+        // page with the same contents if there is one, otherwise [page] is indexed and returned as is
+        RegularFile::page_ptr Intern(const RegularFile::page_ptr &page);
+        Stats GetStats(void);
+        // drop entries of pages that no longer exist
+        void Prune(void);
+
+        static uint64_t Hash(const char *data, quasi_size_t size);
+    };
+
+}
@@ -0,0 +1,90 @@
+// INAA License @marecl 2025
+
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "quasi_types.h"
+
+namespace QuasiFS
+{
+
+    /**
+     * Full-path dentry cache
+     * Maps absolute path (exactly as passed to QFS::Resolve) to its resolution result.
+     * Paths are NOT lexically normalized, since ".." is a real directory entry and may point
+     * somewhere else than lexical parent (symlinks, mountpoints).
+     *
+     * Positive entries are validated against a generation counter, which is bumped by every mutation
+     * that may change existing resolutions (unlink, mount/unmount, chmod).
+     * Counter is shared by all caches, because inodes don't know which QFS they belong to.
+     * Stale entries are dropped right away, so they don't keep removed subtrees alive.
+     *
+     * Negative entries (ENOENT on the last element) are additionally keyed by (parent, leaf).
+     * Adding a name to a directory doesn't change any existing resolution, so link() only
+     * kills negative entries for that exact name instead of bumping the generation.
+     */
+    class DentryCache
+    {
+        // (parent directory, missing name)
+        using NegativeKey = std::pair<const Directory *, std::string>;
+
+        struct NegativeKeyHash
+        {
+            size_t operator()(const NegativeKey &key) const noexcept
+            {
+                return std::hash<const Directory *>{}(key.first) ^ (std::hash<std::string>{}(key.second) << 1);
+            }
+        };
+
+        struct Entry
+        {
+            int status;
+            Resolved res;
+            // negative entries only, flips to false when missing name is linked
+            std::shared_ptr<bool> valid;
+        };
+
+        std::unordered_map<std::string, Entry> entries{};
+        // generation the entries were resolved with
+        uint64_t cached_generation{0};
+
+        static inline uint64_t generation{0};
+        // every live cache, emptied on Invalidate()
+        static inline std::vector<DentryCache *> caches{};
+        // shared by all caches, same as generation
+        static inline std::unordered_map<NegativeKey, std::shared_ptr<bool>, NegativeKeyHash> negative_index{};
+
+    public:
+        // cache is dropped as a whole when it grows above this
+        static constexpr size_t MAX_ENTRIES = 8192;
+
+        DentryCache();
+        ~DentryCache();
+        DentryCache(const DentryCache &) = delete;
+        DentryCache &operator=(const DentryCache &) = delete;
+
+        // mark every cached entry (in every cache) as stale
+        static void Invalidate(void);
+        // for caches living outside of DentryCache, any change means positive resolutions may be stale
+        static uint64_t Generation(void) { return generation; }
+        // [name] was linked into [parent], drop negative entries pointing at it
+        static void InvalidateNegative(const Directory *parent, const std::string &name);
+
+        // returns true on hit, [status] is set to cached resolution status
+        bool Lookup(const fs::path &path, Resolved &res, int &status);
+        void Insert(const fs::path &path, const Resolved &res);
+        // [res] must come from resolution which failed on the last element (parent and leaf are set)
+        void InsertNegative(const fs::path &path, const Resolved &res);
+        void Clear(void);
+
+    private:
+        // drop entries if generation changed, returns true if cache is still valid
+        bool Validate(void);
+        void Reserve(void);
+    };
+
+}
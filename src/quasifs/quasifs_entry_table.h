@@ -0,0 +1,117 @@
+// INAA License @marecl 2025
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "quasi_types.h"
+
+namespace QuasiFS
+{
+
+    /**
+     * Directory entry table
+     * Open-addressing (linear probing) hash table of name -> inode
+     *
+     * Entries live in a dense vector, index holds only 32-bit positions in it.
+     * Name hashes are stored next to entries, so probing compares strings only on hash match
+     * and growing the index never rehashes names.
+     * Removed entries are left as tombstones (null inode) in the dense vector and reused by next
+     * insertions, lowest position first. Position of an entry never changes while it exists, which
+     * makes it usable as a directory stream cursor (see Directory::getdents).
+     * Tombstones at the end of the dense vector are dropped and the index shrinks with the entry
+     * count, so iteration cost follows live entries rather than the largest size table ever had.
+     */
+    class EntryTable
+    {
+    public:
+        using value_type = std::pair<std::string, inode_ptr>;
+
+        // skips tombstones
+        template <typename T>
+        class Iterator
+        {
+            T *current;
+            T *last;
+
+            void skip(void)
+            {
+                while (current != last && nullptr == current->second)
+                    current++;
+            }
+
+        public:
+            Iterator(T *current, T *last) : current(current), last(last) { skip(); }
+
+            T &operator*() const { return *current; }
+            T *operator->() const { return current; }
+            Iterator &operator++()
+            {
+                current++;
+                skip();
+                return *this;
+            }
+            bool operator==(const Iterator &other) const { return current == other.current; }
+            bool operator!=(const Iterator &other) const { return current != other.current; }
+        };
+
+        using iterator = Iterator<value_type>;
+        using const_iterator = Iterator<const value_type>;
+
+    private:
+        static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+        static constexpr size_t MIN_CAPACITY = 8;
+
+        std::vector<value_type> dense{};
+        std::vector<size_t> hashes{};
+        // power of 2, EMPTY_SLOT or position in dense
+        std::vector<uint32_t> index{};
+        // min-heap of tombstones waiting for reuse
+        // positions past the end of dense (trimmed) are stale, they're always on the bottom
+        std::priority_queue<uint32_t, std::vector<uint32_t>, std::greater<uint32_t>> free_positions{};
+        size_t live{0};
+
+    public:
+        EntryTable() = default;
+        ~EntryTable() = default;
+
+        // nullptr if not found
+        inode_ptr find(std::string_view name) const;
+        bool contains(std::string_view name) const { return EMPTY_SLOT != FindSlot(name, Hash(name)); }
+        // false if [name] exists already
+        bool insert(const std::string &name, inode_ptr node);
+        // false if [name] doesn't exist
+        bool erase(std::string_view name);
+        void clear(void);
+
+        size_t size(void) const { return this->live; }
+        bool empty(void) const { return 0 == this->live; }
+
+        // positional access, [pos] < positions(). Tombstones have null inode
+        size_t positions(void) const { return dense.size(); }
+        // index slots
+        size_t capacity(void) const { return index.size(); }
+        const value_type &at(size_t pos) const { return dense[pos]; }
+
+        iterator begin(void) { return iterator(dense.data(), dense.data() + dense.size()); }
+        iterator end(void) { return iterator(dense.data() + dense.size(), dense.data() + dense.size()); }
+        const_iterator begin(void) const { return const_iterator(dense.data(), dense.data() + dense.size()); }
+        const_iterator end(void) const { return const_iterator(dense.data() + dense.size(), dense.data() + dense.size()); }
+
+    private:
+        static size_t Hash(std::string_view name) { return std::hash<std::string_view>{}(name); }
+        // index slot holding [name], EMPTY_SLOT if not found
+        size_t FindSlot(std::string_view name, size_t hash) const;
+        // rebuild index with [capacity] slots
+        void Rehash(size_t capacity);
+        // drop trailing tombstones and shrink index after removal
+        void Compact(void);
+    };
+
+}
@@ -16,7 +16,7 @@ namespace QuasiFS
     {
     public:
         Inode() = default;
-        virtual ~Inode() = default;
+        virtual ~Inode();
 
         static inode_ptr Create(void)
         {
@@ -26,13 +26,42 @@ namespace QuasiFS
         // ioctl(unsigned long op, ...);
         virtual quasi_ssize_t read(quasi_off_t offset, void *buf, quasi_size_t count) { return -QUASI_ENOSYS; }
         virtual quasi_ssize_t write(quasi_off_t offset, const void *buf, quasi_size_t count) { return -QUASI_ENOSYS; }
-        // readv
-        // writev
-        // preadv
+
+        // positional scatter/gather, buffers are processed in order until first short transfer
+        virtual quasi_ssize_t readv(quasi_off_t offset, const quasi_iovec_t *iov, int iovcnt)
+        {
+            quasi_ssize_t total = 0;
+            for (int idx = 0; idx < iovcnt; idx++)
+            {
+                quasi_ssize_t br = read(offset + total, iov[idx].iov_base, iov[idx].iov_len);
+                if (br < 0)
+                    return 0 == total ? br : total;
+                total += br;
+                if (static_cast<quasi_size_t>(br) < iov[idx].iov_len)
+                    break;
+            }
+            return total;
+        }
+
+        virtual quasi_ssize_t writev(quasi_off_t offset, const quasi_iovec_t *iov, int iovcnt)
+        {
+            quasi_ssize_t total = 0;
+            for (int idx = 0; idx < iovcnt; idx++)
+            {
+                quasi_ssize_t bw = write(offset + total, iov[idx].iov_base, iov[idx].iov_len);
+                if (bw < 0)
+                    return 0 == total ? bw : total;
+                total += bw;
+                if (static_cast<quasi_size_t>(bw) < iov[idx].iov_len)
+                    break;
+            }
+            return total;
+        }
 
         virtual quasi_off_t lseek(quasi_off_t offset, QuasiFS::SeekOrigin origin) { return -QUASI_ENOSYS; }
         virtual int ftruncate(quasi_off_t length) { return -QUASI_ENOSYS; };
-        virtual ssize_t getdents(void *buf, unsigned int nbytes, size_t *basep) { return -QUASI_ENOSYS; };
+        // [basep] is an opaque directory stream cursor, updated on return
+        virtual quasi_ssize_t getdents(void *buf, quasi_size_t nbytes, quasi_off_t *basep) { return -QUASI_ENOSYS; };
         virtual int fsync(void) { return -QUASI_ENOSYS; };
 
         virtual int fstat(quasi_stat_t *stat)
@@ -61,6 +90,8 @@ namespace QuasiFS
 
         fileno_t fileno{-1};
         quasi_stat_t st{};
+        // partition that assigned [fileno], gets it back on destruction
+        std::weak_ptr<Partition> owner{};
 
         int chmod(quasi_mode_t mode)
         {
@@ -2,22 +2,52 @@
 
 #pragma once
 
-#include <map>
 #include <string>
+#include <string_view>
 
 #include "quasi_sys_stat.h"
 #include "quasi_types.h"
+#include "quasifs_entry_table.h"
 #include "quasifs_inode.h"
 
 namespace QuasiFS
 {
 
-    // Directory
+    /**
+     * Directory
+     * "." and ".." aren't stored in [entries], they're synthesized from non-owning back-pointers,
+     * so directories never keep themselves or their parents alive. They're listed first (getdents
+     * cursors 0 and 1), count towards st_size and st_nlink, but don't make directory non-empty.
+     */
     class Directory : public Inode
     {
+        static bool is_relative_name(std::string_view name) { return "." == name || ".." == name; }
+
+        // "." and "..", partition root is its own parent
+        std::weak_ptr<Directory> self{};
+        std::weak_ptr<Directory> parent{};
+
     public:
-        std::map<std::string, inode_ptr> entries{};
+        // getdents cursors taken by "." and ".."
+        static constexpr quasi_off_t RELATIVE_ENTRIES = 2;
+
+        // number of entries by type, without "." and ".."
+        struct EntryCounts
+        {
+            uint32_t files{0};
+            uint32_t dirs{0};
+            uint32_t links{0};
+            uint32_t devices{0};
+            uint32_t other{0};
+        };
+
+        // hashed, lookups with string_view
+        EntryTable entries{};
         dir_ptr mounted_root = nullptr;
+        // partition mounted in this directory, set and cleared together with mounted_root
+        partition_ptr mounted_partition = nullptr;
+        // updated on every link/unlink, st.st_size is kept as the sum of dirent_t records
+        EntryCounts counts{};
 
         Directory();
         ~Directory() = default;
@@ -33,9 +63,10 @@ namespace QuasiFS
 
         virtual quasi_ssize_t read(quasi_off_t offset, void *buf, quasi_size_t count) override { return -QUASI_EISDIR; }
         virtual quasi_ssize_t write(quasi_off_t offset, const void *buf, quasi_size_t count) override { return -QUASI_EISDIR; }
+        // packs variable-length dirent_t records into [buf], [basep] is the position in entry table
+        virtual quasi_ssize_t getdents(void *buf, quasi_size_t nbytes, quasi_off_t *basep) override;
         virtual int fstat(quasi_stat_t *stat) override
         {
-            this->st.st_size = entries.size() * 32;
             *stat = st;
             return 0;
         }
@@ -45,14 +76,28 @@ namespace QuasiFS
         //
 
         // Find an element with [name]
-        inode_ptr lookup(const std::string &name);
+        inode_ptr lookup(std::string_view name);
 
         // Add hardlink to [child] with [name]
         int link(const std::string &name, inode_ptr child);
+        // Set up "." and ".." of [self], once, right after it's linked into [parent]
+        static void link_relatives(const dir_ptr &self, const dir_ptr &parent);
         // Remove hardlink to [name]
         int unlink(const std::string &name);
-        // list entries
+        // list entries, "." and ".." included
         std::vector<std::string> list();
+        // no entries other than "." and ".."
+        bool is_empty(void) const
+        {
+            return 0 == counts.files + counts.dirs + counts.links + counts.devices + counts.other;
+        }
+
+        // size of dirent_t record holding [name_length] long name
+        static quasi_size_t dirent_size(size_t name_length);
+
+    private:
+        // +1 or -1 to counter matching [child] type and record size of [name]
+        void account(const std::string &name, const inode_ptr &child, int delta);
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,81 @@
+// INAA License @marecl 2025
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "quasi_types.h"
+
+namespace QuasiFS
+{
+
+    /**
+     * Bulk storage for inodes of a single partition (see Partition::NewInode)
+     * Memory is carved out of large chunks, slots are rounded up to SLOT_ALIGN and recycled
+     * through per-size free lists. Chunks are only returned when the pool is destroyed.
+     *
+     * Inodes (and their shared_ptr control blocks) may outlive the partition (open handles, caches),
+     * so every allocation holds the pool alive through InodeAllocator. Pool goes away
+     * together with the last of them, all chunks at once.
+     * Allocations larger than MAX_SLOT go straight to the global heap.
+     */
+    class InodePool
+    {
+    public:
+        static constexpr size_t CHUNK_SIZE = 256 * 1024;
+        static constexpr size_t SLOT_ALIGN = 16;
+        static constexpr size_t MAX_SLOT = 1024;
+
+    private:
+        static constexpr size_t SIZE_CLASSES = MAX_SLOT / SLOT_ALIGN;
+
+        std::vector<void *> chunks{};
+        // intrusive, next pointer is stored in the freed slot
+        std::array<void *, SIZE_CLASSES> free_lists{};
+        char *bump{nullptr};
+        char *bump_end{nullptr};
+
+        static size_t SizeClass(size_t size) { return (size + SLOT_ALIGN - 1) / SLOT_ALIGN - 1; }
+
+    public:
+        InodePool() = default;
+        ~InodePool();
+
+        InodePool(const InodePool &) = delete;
+        InodePool &operator=(const InodePool &) = delete;
+
+        static std::shared_ptr<InodePool> Create(void)
+        {
+            return std::make_shared<InodePool>();
+        }
+
+        void *Allocate(size_t size);
+        void Deallocate(void *ptr, size_t size);
+
+        size_t ChunkCount(void) const { return this->chunks.size(); }
+    };
+    using inode_pool_ptr = std::shared_ptr<InodePool>;
+
+    // for std::allocate_shared, keeps the pool alive as long as anything allocated from it
+    template <typename T>
+    struct InodeAllocator
+    {
+        using value_type = T;
+        static_assert(alignof(T) <= InodePool::SLOT_ALIGN, "QuasiFS:InodeAllocator: Overaligned type");
+
+        inode_pool_ptr pool;
+
+        explicit InodeAllocator(inode_pool_ptr pool) : pool(std::move(pool)) {}
+        template <typename U>
+        InodeAllocator(const InodeAllocator<U> &other) : pool(other.pool) {}
+
+        T *allocate(size_t n) { return static_cast<T *>(this->pool->Allocate(n * sizeof(T))); }
+        void deallocate(T *ptr, size_t n) { this->pool->Deallocate(ptr, n * sizeof(T)); }
+
+        template <typename U>
+        bool operator==(const InodeAllocator<U> &other) const { return this->pool == other.pool; }
+    };
+
+}
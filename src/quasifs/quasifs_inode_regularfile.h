@@ -2,19 +2,102 @@
 
 #pragma once
 
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
 #include "quasi_types.h"
 #include "quasifs_inode.h"
 
 namespace QuasiFS
 {
 
+    /**
+     * File contents are stored in fixed-size pages, so growing a file never moves existing data
+     * and I/O only touches pages within requested range.
+     * Pages are allocated on first write, missing page reads back as zeros.
+     * Unallocated pages are holes (SEEK_HOLE), hole granularity is one page.
+     * Pages are reference counted and may be shared between files (clone()),
+     * shared page is copied on first write to it.
+     * Pages can be pinned by FileMapping, which doesn't count as sharing.
+     *
+     * Files up to INLINE_SIZE bytes keep contents inside the inode instead, page table stays empty.
+     * Contents are moved to a page as soon as file grows past that, or when it's cloned/mapped.
+     * File goes back inline only when it's truncated to 0.
+     * Inline buffer past EOF (and whole buffer for paged files) is always zeroed.
+     *
+     * Pages of files left alone for a while can be compressed (sweep(), driven by Partition).
+     * Compressed page leaves the page table, but isn't a hole, and is decompressed on first access.
+     * Pages shared with clones or pinned by mappings are never compressed.
+     *
+     * Pages can also be shared with identical pages of unrelated files through DedupStore (dedup()).
+     */
     class RegularFile : public Inode
     {
-        std::vector<char> data{};
+        friend class FileMapping;
+
+    public:
+        static constexpr quasi_size_t PAGE_SIZE = 64 * 1024;
+        static constexpr quasi_size_t INLINE_SIZE = 96;
+
+        struct Page
+        {
+            // number of files holding this page, copy-on-write if more than one
+            uint32_t owners{1};
+            char data[PAGE_SIZE];
+        };
+        using page_ptr = std::shared_ptr<Page>;
+
+    private:
+        // pages past the end of table are holes as well (MockWrite grows st_size only)
+        std::vector<page_ptr> pages{};
+        // clone() would share pages that are being written to behind our back
+        uint32_t writable_maps{0};
+        // contents of small files, see IsInline()
+        char inline_data[INLINE_SIZE]{};
+
+        struct PackedPages
+        {
+            // immutable, clones share them
+            std::unordered_map<quasi_size_t, std::shared_ptr<const std::vector<char>>> pages{};
+            compression_stats_ptr stats{};
+        };
+        // allocated when first page gets compressed
+        std::unique_ptr<PackedPages> packed{};
+        // sweeps since last access
+        uint32_t idle_sweeps{0};
+        // pages were written to since last dedup()
+        bool dedup_pending{false};
+
+        static quasi_size_t PageCount(quasi_size_t size) { return (size + PAGE_SIZE - 1) / PAGE_SIZE; }
+        bool IsHole(quasi_size_t page_idx) const { return page_idx >= pages.size() || (nullptr == pages[page_idx] && !IsPacked(page_idx)); }
+        bool IsPacked(quasi_size_t page_idx) const { return nullptr != packed && packed->pages.contains(page_idx); }
+        // page contents, decompressed if needed, nullptr for holes
+        const char *ReadablePage(quasi_size_t page_idx);
+        // page ready to be written to, allocated or unshared if needed (page table must cover it)
+        char *WritablePage(quasi_size_t page_idx);
+        // drop page from the table, page stays alive if anything else holds it
+        void ReleasePage(page_ptr &page);
+
+        bool IsInline(void) const { return this->pages.empty() && static_cast<quasi_size_t>(this->st.st_size) <= INLINE_SIZE; }
+        // move inline contents to the first page, file is no longer inline after growing past INLINE_SIZE
+        // all-zero contents are left as a hole unless [force]d (mapping must pin a real page)
+        void SpillInline(bool force = false);
+
+        // compressed page back into the page table
+        void UnpackPage(quasi_size_t page_idx);
+        // forget compressed pages at and past [first_page_idx]
+        void DropPacked(quasi_size_t first_page_idx = 0);
+
+        // compressed page is kept only if it saves at least this much
+        static constexpr quasi_size_t MAX_PACKED_SIZE = PAGE_SIZE - PAGE_SIZE / 8;
+
+        // st_blocks, in 512-byte units
+        static constexpr quasi_size_t BLOCKS_PER_PAGE = PAGE_SIZE / 512;
 
     public:
         RegularFile();
-        ~RegularFile() = default;
+        ~RegularFile();
 
         static file_ptr Create(void)
         {
@@ -27,6 +110,17 @@ namespace QuasiFS
         quasi_ssize_t read(quasi_off_t offset, void *buf, quasi_size_t count) override;
         quasi_ssize_t write(quasi_off_t offset, const void *buf, quasi_size_t count) override;
         int ftruncate(quasi_off_t length) override;
+        // replace contents with [src]'s, pages are shared until either file writes to them
+        // -QUASI_EBUSY if [src] is mapped for writing
+        int clone(const RegularFile &src);
+        // count a sweep without access, compress pages once file has been idle for [idle_limit] sweeps
+        // returns number of pages compressed
+        quasi_size_t sweep(uint32_t idle_limit, const compression_stats_ptr &stats);
+        // replace pages with identical ones from [store], returns number of pages replaced
+        // no-op if nothing was written since last call
+        quasi_size_t dedup(DedupStore &store);
+        // SeekOrigin::DATA / SeekOrigin::HOLE only, -QUASI_ENXIO if [offset] is at or past EOF
+        quasi_off_t lseek(quasi_off_t offset, QuasiFS::SeekOrigin origin) override;
 
         //
         // Mock functions
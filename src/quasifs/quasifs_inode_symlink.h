@@ -2,6 +2,9 @@
 
 #pragma once
 
+#include <string>
+#include <string_view>
+
 #include "quasi_types.h"
 #include "quasifs_inode.h"
 
@@ -10,7 +13,23 @@ namespace QuasiFS
 
     class Symlink : public Inode
     {
-        const fs::path target;
+        // kept as a native string, resolver walks it in-place without parsing it into fs::path
+        const std::string target;
+
+        // last resolution of the target, valid as long as dentry generation doesn't change
+        // and it's looked up from the same tree (partition may be mounted in many QFS)
+        // nothing is owned here, dead inodes simply invalidate the entry
+        struct CachedTarget
+        {
+            uint64_t generation{0};
+            std::weak_ptr<Directory> root{};
+            std::weak_ptr<Partition> mountpoint{};
+            std::weak_ptr<Directory> parent{};
+            std::weak_ptr<Inode> node{};
+            std::string local_path{};
+            std::string leaf{};
+        } cached_target{};
+        bool has_cached_target{false};
 
     public:
         Symlink(fs::path target);
@@ -23,6 +42,15 @@ namespace QuasiFS
 
         // symlinked path
         fs::path follow(void);
+        // same as above, without a copy
+        std::string_view follow_view(void) const { return this->target; }
+
+        // fill [res] with cached target resolution (except local_path), returns false if there's none or it's stale
+        // [root] is the root directory target is resolved from, entries cached from other roots are ignored
+        // [local_path] views cached local path, good until next CacheTarget() call
+        bool LookupTarget(const dir_ptr &root, Resolved &res, std::string_view &local_path);
+        // store successful resolution of the target, made from [root]
+        void CacheTarget(const dir_ptr &root, const Resolved &res);
     };
 
-}
\ No newline at end of file
+}
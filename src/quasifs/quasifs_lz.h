@@ -0,0 +1,22 @@
+// INAA License @marecl 2025
+
+#pragma once
+
+#include "quasi_types.h"
+
+namespace QuasiFS::LZ
+{
+
+    /**
+     * Byte-oriented LZ77 block codec, same sequence layout as LZ4 blocks:
+     * token (literal length << 4 | match length - 4), literal length overflow (255-runs), literals,
+     * little-endian 16-bit offset, match length overflow. Last sequence carries literals only.
+     * Meant for whole pages, so a block never exceeds 64 KiB of history.
+     */
+
+    // returns compressed size, 0 if it doesn't fit in [dst_capacity]
+    quasi_size_t Compress(const char *src, quasi_size_t src_size, char *dst, quasi_size_t dst_capacity);
+    // returns decompressed size, -QUASI_EINVAL if [src] is corrupted or doesn't fit in [dst_capacity]
+    quasi_ssize_t Decompress(const char *src, quasi_size_t src_size, char *dst, quasi_size_t dst_capacity);
+
+}
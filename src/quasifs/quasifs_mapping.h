@@ -0,0 +1,63 @@
+// INAA License @marecl 2025
+
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "quasi_types.h"
+#include "quasifs_inode_regularfile.h"
+
+namespace QuasiFS
+{
+
+    /**
+     * Zero-copy view of RegularFile contents (see QFS::Map)
+     * Mapped range is exposed as segments, one per page it touches, since pages aren't contiguous.
+     * Pages stay pinned for the lifetime of the mapping, so spans never dangle.
+     *
+     * Writes through a writable mapping land directly in file's pages (shared mapping),
+     * reads see file's writes as long as the mapping is valid.
+     * Mapping becomes invalid when any mapped page is replaced or dropped: truncation below the
+     * mapped range, clone() into the file, copy-on-write of a shared page or hole being filled.
+     * Invalid mapping returns empty segments, remap to see current contents.
+     */
+    class FileMapping
+    {
+        std::weak_ptr<RegularFile> file{};
+        // one per mapped page, nullptr for holes (read back as zeros)
+        std::vector<RegularFile::page_ptr> pins{};
+        quasi_off_t offset{0};
+        quasi_size_t length{0};
+        bool writable{false};
+
+    public:
+        FileMapping() = default;
+        ~FileMapping();
+
+        FileMapping(const FileMapping &) = delete;
+        FileMapping &operator=(const FileMapping &) = delete;
+        FileMapping(FileMapping &&other) noexcept;
+        FileMapping &operator=(FileMapping &&other) noexcept;
+
+        // map [length] bytes of [file] starting at [offset], range must be within file
+        // writable mapping allocates holes and unshares cloned pages in range upfront
+        int Map(const file_ptr &file, quasi_off_t offset, quasi_size_t length, bool writable);
+        void Unmap(void);
+
+        bool IsValid(void) const;
+        bool IsWritable(void) const { return writable; }
+        quasi_off_t Offset(void) const { return offset; }
+        quasi_size_t Size(void) const { return length; }
+
+        size_t Segments(void) const { return pins.size(); }
+        // contiguous part of the mapping, empty if mapping (or this page) is no longer valid
+        std::span<const char> Segment(size_t idx) const;
+        // same as above, empty for read-only mappings
+        std::span<char> WritableSegment(size_t idx);
+
+    private:
+        bool IsPageValid(const RegularFile &file, size_t idx) const;
+    };
+
+}
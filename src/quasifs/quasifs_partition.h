@@ -2,20 +2,33 @@
 
 #pragma once
 
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
 #include "quasi_types.h"
+#include "quasifs_inode_pool.h"
 
 namespace QuasiFS
 {
 
     class Partition : public std::enable_shared_from_this<Partition>
     {
+        // returns fileno on destruction
+        friend class Inode;
+
     private:
-        fileno_t NextFileno(void) { return this->next_fileno++; };
+        fileno_t NextFileno(void);
+
+        // storage of every inode created through NewInode()
+        inode_pool_ptr inode_pool{InodePool::Create()};
 
-        // file list
-        std::unordered_map<fileno_t, inode_ptr> inode_table{};
+        // file list, indexed by fileno, nullptr for unused numbers
+        std::vector<inode_ptr> inode_table{};
+
+        // numbers of destroyed inodes, reused last-in first-out
+        // removed inode keeps its number for as long as it's alive (open after unlink)
+        std::vector<fileno_t> free_filenos{};
+        void ReleaseFileno(fileno_t fileno) { this->free_filenos.push_back(fileno); }
 
         dir_ptr root;
         fileno_t next_fileno = 2;
@@ -25,6 +38,12 @@ namespace QuasiFS
 
         const fs::path host_root{};
 
+        // idle file compression, 0 - disabled
+        uint32_t compress_idle_sweeps{0};
+        compression_stats_ptr compression_stats{std::make_shared<CompressionStats>()};
+        // shared with other partitions, nullptr - disabled
+        dedup_store_ptr dedup_store{};
+
     public:
         // host-bound directory, permissions for root directory
         Partition(const fs::path &host_root = "", const int root_permissions = 0755);
@@ -45,16 +64,47 @@ namespace QuasiFS
         bool IsHostMounted(void) { return !this->host_root.empty(); }
         blkid_t GetBlkId(void) { return this->block_id; }
         inode_ptr GetInodeByFileno(fileno_t fileno);
-
+        inode_pool_ptr GetInodePool(void) { return this->inode_pool; }
+
+        // compress files left untouched for [idle_sweeps] calls to SweepIdle(), 0 disables
+        // compressed pages stay compressed until accessed
+        // -QUASI_EOPNOTSUPP for host-bound partitions, their contents don't live in memory
+        int SetCompression(uint32_t idle_sweeps);
+        // meant to be called periodically, returns number of pages compressed
+        quasi_size_t SweepIdle(void);
+        CompressionStats GetCompressionStats(void) const { return *this->compression_stats; }
+
+        // share identical pages with every partition using [store], nullptr disables
+        // files are deduplicated when closed after writing, or on demand with Deduplicate()
+        // -QUASI_EOPNOTSUPP for host-bound partitions
+        int SetDedupStore(dedup_store_ptr store);
+        dedup_store_ptr GetDedupStore(void) { return this->dedup_store; }
+        // returns number of pages replaced with ones from dedup store
+        quasi_size_t Deduplicate(const file_ptr &file);
+        quasi_size_t Deduplicate(void);
+
+        // Resolve path within partition
+        // Path is consumed up to the first mountpoint or symlink, remainder is left in [path]
         int Resolve(fs::path &path, Resolved &res);
+        int Resolve(std::string_view &path, Resolved &res);
+        // Same as above, but local path is returned as a view into [path] instead of being stored in [res]
+        // If [start] is set, [path] is relative to it (and so is [local_path])
+        int Resolve(std::string_view &path, Resolved &res, std::string_view &local_path, dir_ptr start = nullptr);
+
+        // same as T::Create(), but allocated from partition's inode pool
+        template <typename T, typename... Args>
+        std::shared_ptr<T> NewInode(Args &&...args)
+        {
+            static_assert(std::is_base_of_v<Inode, T>, " QuasiFS:Partition:NewInode Created element must derive from Inode");
+            return std::allocate_shared<T>(InodeAllocator<T>(this->inode_pool), std::forward<Args>(args)...);
+        }
 
         // create file at path (creates entry in parent dir). returns 0 or negative errno
         template <typename T>
         int touch(dir_ptr parent, const std::string &name)
         {
-            if constexpr (!std::is_base_of_v<Inode, T>)
-                return touch(parent, name, T::Create());
             static_assert(std::is_base_of_v<Inode, T>, " QuasiFS:Partition:Touch Created element must derive from Inode");
+            return touch(parent, name, NewInode<T>());
         }
         int touch(dir_ptr parent, const std::string &name, inode_ptr child);
 
@@ -1,6 +1,8 @@
 // INAA License @marecl 2025
 
 #include "../quasi_errno.h"
+#include "../quasi_sys_fcntl.h"
+#include "../quasi_sys_mman.h"
 #include "../quasi_types.h"
 
 #include "../quasifs.h"
@@ -195,7 +197,9 @@ namespace QuasiFS
         };
 
         dir->mounted_root = fs_root;
+        dir->mounted_partition = fs;
         this->block_devices[fs] = fs_options;
+        DentryCache::Invalidate();
 
         return 0;
     }
@@ -227,7 +231,9 @@ namespace QuasiFS
             return -QUASI_EINVAL;
 
         options_parentdir->mounted_root = nullptr;
+        options_parentdir->mounted_partition = nullptr;
         this->block_devices.erase(part);
+        DentryCache::Invalidate();
 
         return 0;
     }
@@ -245,10 +251,137 @@ namespace QuasiFS
     }
 
     int QFS::Resolve(const fs::path &path, Resolved &res)
+    {
+        int status{-1};
+
+        if (this->dentry_cache.Lookup(path, res, status))
+            return status;
+
+        status = ResolveImpl(path.native(), res);
+        if (0 == status)
+            this->dentry_cache.Insert(path, res);
+        // only the last element is missing, parent directory is known
+        else if (-QUASI_ENOENT == status && nullptr != res.mountpoint && nullptr != res.parent)
+            this->dentry_cache.InsertNegative(path, res);
+        return status;
+    }
+
+    int QFS::ResolveAt(const int dirfd, const fs::path &path, Resolved &res)
+    {
+        // no CWD, so QUASI_AT_FDCWD is the same as regular resolution (relative paths are rejected)
+        if (QUASI_AT_FDCWD == dirfd || path.is_absolute())
+            return Resolve(path, res);
+
+        fd_handle_ptr handle = GetHandle(dirfd);
+        if (nullptr == handle || !handle->IsOpen())
+            return -QUASI_EBADF;
+        if (!handle->node->is_dir())
+            return -QUASI_ENOTDIR;
+
+        // not cached, relative paths are meaningless without the directory
+        return ResolveImpl(path.native(), res, handle);
+    }
+
+    int QFS::ResolveMany(std::span<const fs::path> paths, std::span<Resolved> res, std::span<int> status)
+    {
+        if (res.size() < paths.size())
+            return -QUASI_EINVAL;
+        if (!status.empty() && status.size() < paths.size())
+            return -QUASI_EINVAL;
+
+        // results are not inserted into dentry cache, a big batch would only push out the hot entries
+        // views point into [paths], so they're good until we return
+        prefix_memo_t memo{};
+        int resolved{0};
+
+        for (size_t idx = 0; idx < paths.size(); idx++)
+        {
+            const fs::path &path = paths[idx];
+            Resolved &path_res = res[idx];
+            int path_status{-1};
+
+            if (this->dentry_cache.Lookup(path, path_res, path_status))
+            {
+                if (!status.empty())
+                    status[idx] = path_status;
+                resolved += 0 == path_status;
+                continue;
+            }
+
+            const std::string_view path_view = path.native();
+            const size_t leaf_start = path_view.rfind('/');
+
+            // anything that doesn't split cleanly into (directory, name) goes the long way
+            // name length is checked here too, since relative walk only sees the leaf
+            bool simple = !path_view.empty() && '/' == path_view.front() && '/' != path_view.back() &&
+                          std::string_view::npos == path_view.find("//") && path_view.size() < 256;
+
+            PrefixState *dir = nullptr;
+            if (simple)
+                dir = ResolvePrefix(memo, 0 == leaf_start ? path_view.substr(0, 1) : path_view.substr(0, leaf_start));
+
+            if (nullptr == dir)
+                // error semantics (ENOENT in the middle, ENOTDIR, ELOOP) are easier to get right with a full walk
+                path_status = ResolveImpl(path_view, path_res);
+            else
+            {
+                // prefix state is shared by other paths, leaf walk spends a copy of its budget
+                uint8_t hops_left = dir->hops_left;
+                path_status = ResolveImpl(path_view.substr(leaf_start + 1), path_res, &dir->dir, &hops_left);
+            }
+
+            if (!status.empty())
+                status[idx] = path_status;
+            resolved += 0 == path_status;
+        }
+
+        return resolved;
+    }
+
+    QFS::PrefixState *QFS::ResolvePrefix(prefix_memo_t &memo, std::string_view prefix)
+    {
+        // memo is node-based, states handed out earlier stay put while it grows
+        if (auto it = memo.find(prefix); memo.end() != it)
+            return it->second.dir.IsOpen() ? &it->second : nullptr;
+
+        // left closed if prefix doesn't resolve to a directory
+        PrefixState state{};
+
+        if ("/" == prefix)
+        {
+            state.dir.node = this->root;
+            state.dir.mountpoint = this->rootfs;
+            state.dir.local_path = "/";
+        }
+        else
+        {
+            // walk one element from parent's state, it's already resolved (or known to be broken)
+            const size_t leaf_start = prefix.rfind('/');
+            PrefixState *parent = ResolvePrefix(memo, 0 == leaf_start ? prefix.substr(0, 1) : prefix.substr(0, leaf_start));
+
+            Resolved res;
+            if (nullptr != parent)
+            {
+                // continues parent's walk, hops taken to get there count here too
+                state.hops_left = parent->hops_left;
+                if (0 == ResolveImpl(prefix.substr(leaf_start + 1), res, &parent->dir, &state.hops_left) && res.node->is_dir())
+                {
+                    state.dir.node = res.node;
+                    state.dir.mountpoint = res.mountpoint;
+                    state.dir.local_path = std::move(res.local_path);
+                }
+            }
+        }
+
+        PrefixState &stored = memo.emplace(prefix, std::move(state)).first->second;
+        return stored.dir.IsOpen() ? &stored : nullptr;
+    }
+
+    int QFS::ResolveImpl(std::string_view path, Resolved &res, fd_handle_ptr start, uint8_t *hops_left)
     {
         if (path.empty())
             return -QUASI_EINVAL;
-        if (path.is_relative())
+        if (nullptr == start && '/' != path.front())
             return -QUASI_EBADF;
 
         // on return:
@@ -258,26 +391,52 @@ namespace QuasiFS
         // leaf - name of the last element in the path (if exists)
 
         // guard against circular binds
-        uint8_t safety_counter = 40;
+        uint8_t safety_counter = nullptr == hops_left ? MAX_RESOLVE_HOPS : *hops_left;
         //
         int status{-1};
 
-        fs::path iter_path = path;
-
-        res.mountpoint = this->rootfs;
-        res.local_path = iter_path;
-        res.parent = this->root;
-        res.node = this->root;
+        // path is walked in-place, a copy is made only when symlink target has to be spliced in
+        std::string symlink_path{};
+        std::string_view iter_path = path;
+        // view into the path of the last walked partition, materialized once the walk is done
+        std::string_view local_path = iter_path;
+
+        // walk starts in a directory, local path has to be prefixed with its path
+        // until the first jump to an absolute location (symlink, mountpoint)
+        dir_ptr start_dir = nullptr;
+        std::string_view local_prefix{};
+        // keeps cached symlink target (and the view into it) alive
+        symlink_ptr followed_link = nullptr;
+        // symlink followed as the last element, its target is cached once the walk succeeds
+        symlink_ptr pending_link = nullptr;
+
+        if (nullptr == start)
+        {
+            res.mountpoint = this->rootfs;
+            res.parent = this->root;
+            res.node = this->root;
+        }
+        else
+        {
+            start_dir = std::static_pointer_cast<Directory>(start->node);
+            local_prefix = start->local_path.native();
+            res.mountpoint = start->mountpoint;
+            res.parent = start_dir;
+            res.node = start_dir;
+        }
 
         do
         {
-            if (iter_path.string().size() >= 256)
-                return -QUASI_ENAMETOOLONG;
+            if (iter_path.size() >= 256)
+            {
+                status = -QUASI_ENAMETOOLONG;
+                break;
+            }
 
-            status = res.mountpoint->Resolve(iter_path, res);
+            status = res.mountpoint->Resolve(iter_path, res, local_path, start_dir);
 
             if (0 != status)
-                return status;
+                break;
 
             if (res.node->is_link())
             {
@@ -286,15 +445,65 @@ namespace QuasiFS
                 // path resolution will enter /link, and extract it as /dirA/dirB.
                 // from that same path, /dirC will be preserved and appened to symlink's target,
                 // which will yield /dirA/dirB/dirC
-                fs::path leftover = iter_path;
+                const std::string_view leftover = iter_path;
+                symlink_ptr link = std::static_pointer_cast<Symlink>(res.node);
+
+                // target resolved before, either it's the result or we continue walking from there
+                Resolved target_res;
+                std::string_view target_local_path{};
+                if (FollowSymlink(link, target_res, target_local_path))
+                {
+                    if (leftover.empty() || target_res.node->is_dir())
+                    {
+                        followed_link = link;
+                        res.mountpoint = target_res.mountpoint;
+                        res.parent = target_res.parent;
+                        res.node = target_res.node;
+                        res.leaf = target_res.leaf;
+                        local_path = target_local_path;
+                        start_dir = nullptr;
+
+                        // every followed link counts towards the limit, last one too
+                        if (leftover.empty())
+                        {
+                            --safety_counter;
+                            break;
+                        }
+
+                        start_dir = std::static_pointer_cast<Directory>(target_res.node);
+                        local_prefix = target_local_path;
+                        res.parent = start_dir;
+                        iter_path = leftover;
+                        continue;
+                    }
+                    // anything else is an error, full walk will report it properly
+                }
+                else if (leftover.empty() && nullptr == pending_link)
+                    // nested walk, result of the spliced path is also link's target
+                    pending_link = link;
+
                 // main path is overwritten with absolute path from symlink
-                iter_path = std::static_pointer_cast<Symlink>(res.node)->follow();
+                const std::string_view target = link->follow_view();
                 // and if it's really in the way - restore leftover items
 
-                //   Log("Found a symlink to [{}] // merging with // {}", iter_path.string(), leftover.string());
+                //   Log("Found a symlink to [{}] // merging with // {}", target, leftover);
 
+                // leftover may point into symlink_path, so it can't be overwritten in-place
+                std::string next_path{};
+                next_path.reserve(target.size() + leftover.size() + 1);
+                next_path = target;
                 if (!leftover.empty())
-                    iter_path /= leftover;
+                {
+                    if (!next_path.empty() && '/' != next_path.back())
+                        next_path += '/';
+                    next_path += leftover;
+                }
+                symlink_path = std::move(next_path);
+                iter_path = symlink_path;
+                // old view may point into the replaced path, loop can end before it's walked again
+                local_path = iter_path;
+                start_dir = nullptr;
+
                 // reset everything to point to rootfs, where absolute path can be resolved again
                 res.mountpoint = this->rootfs;
                 res.parent = this->root;
@@ -322,13 +531,17 @@ namespace QuasiFS
                     if (nullptr == mounted_partition)
                     {
                         res.mountpoint = nullptr;
-                        return -QUASI_ENOENT;
+                        status = -QUASI_ENOENT;
+                        break;
                     }
 
                     res.mountpoint = mounted_partition;
                     res.parent = mntparent;
                     res.node = mntroot;
                     res.leaf = "/";
+                    // from now on it's mounted partition's path
+                    local_path = iter_path.substr(0, 1);
+                    start_dir = nullptr;
 
                     if (iter_path != "/")
                         continue;
@@ -339,12 +552,56 @@ namespace QuasiFS
 
         } while (--safety_counter > 0);
 
+        if (nullptr != start_dir)
+        {
+            // same as local_prefix / local_path, without parsing both sides
+            std::string joined{};
+            joined.reserve(local_prefix.size() + local_path.size() + 1);
+            joined = local_prefix;
+            if (!local_path.empty() && !joined.empty() && '/' != joined.back())
+                joined += '/';
+            joined += local_path;
+            res.local_path = std::move(joined);
+        }
+        else
+            res.local_path = local_path;
+
+        if (nullptr != hops_left)
+            *hops_left = safety_counter;
+
+        if (0 != status)
+            return status;
+
         if (0 == safety_counter)
             return -QUASI_ELOOP;
 
+        if (nullptr != pending_link)
+            pending_link->CacheTarget(this->root, res);
+
         return 0;
     }
 
+    bool QFS::FollowSymlink(const symlink_ptr &link, Resolved &res, std::string_view &local_path)
+    {
+        if (link->LookupTarget(this->root, res, local_path))
+            return true;
+
+        // only the outermost walk resolves targets on its own, nested ones splice paths as usual
+        // otherwise link -> link -> ... chains would multiply loop counters
+        if (this->following_symlink)
+            return false;
+
+        this->following_symlink = true;
+        int status = ResolveImpl(link->follow_view(), res);
+        this->following_symlink = false;
+
+        if (0 != status)
+            return false;
+
+        link->CacheTarget(this->root, res);
+        return link->LookupTarget(this->root, res, local_path);
+    }
+
     int QFS::GetHostPath(fs::path &output, const fs::path &path)
     {
         Resolved res;
@@ -384,10 +641,41 @@ namespace QuasiFS
 
     quasi_ssize_t QFS::GetDirectorySize(const fs::path &path) noexcept
     {
-        UNIMPLEMENTED();
-        return -QUASI_ENOSYS;
+        Resolved res;
+        if (int status = Resolve(path, res); 0 != status)
+            return status;
+
+        if (!res.node->is_dir())
+            return -QUASI_ENOTDIR;
+
+        // kept up to date by link/unlink, same as buffer size needed to getdents() whole directory
+        return res.node->st.st_size;
     };
 
+    int QFS::Map(const int fd, quasi_off_t offset, quasi_size_t length, int prot, FileMapping &mapping) noexcept
+    {
+        fd_handle_ptr handle = GetHandle(fd);
+        if (nullptr == handle)
+            return -QUASI_EBADF;
+
+        if (0 != (prot & ~(QUASI_PROT_READ | QUASI_PROT_WRITE)))
+            return -QUASI_EINVAL;
+
+        const inode_ptr &node = handle->node;
+        if (!node->is_file() || handle->IsHostBound())
+            return -QUASI_ENODEV;
+
+        // mapping is always readable, same as mmap
+        if (!handle->read)
+            return -QUASI_EACCES;
+
+        bool writable = prot & QUASI_PROT_WRITE;
+        if (writable && (!handle->write || handle->append))
+            return -QUASI_EACCES;
+
+        return mapping.Map(std::static_pointer_cast<RegularFile>(node), offset, length, writable);
+    }
+
     //
     // Privates (don't touch)
     //
@@ -436,12 +724,12 @@ namespace QuasiFS
 
                 if (entry->is_directory())
                 {
-                    new_inode = Directory::Create();
+                    new_inode = part->NewInode<Directory>();
                     part->mkdir(parent_dir, leaf, std::static_pointer_cast<Directory>(new_inode));
                 }
                 else if (entry->is_regular_file())
                 {
-                    new_inode = RegularFile::Create();
+                    new_inode = part->NewInode<RegularFile>();
                     part->touch(parent_dir, leaf, std::static_pointer_cast<RegularFile>(new_inode));
                 }
                 else
@@ -450,11 +738,20 @@ namespace QuasiFS
                     continue;
                 }
 
-                if (0 != this->hio_driver.Stat(entry_path, &new_inode->st))
+                quasi_stat_t host_st{};
+                if (0 != this->hio_driver.Stat(entry_path, &host_st))
                 {
                     LogError("Cannot stat file: {}", entry_path.string());
                     continue;
                 }
+
+                // link count and directory size are kept by the partition, don't take host's
+                new_inode->st.st_mode = (new_inode->st.st_mode & QUASI_S_IFMT) | (host_st.st_mode & ~QUASI_S_IFMT);
+                new_inode->st.st_atim = host_st.st_atim;
+                new_inode->st.st_mtim = host_st.st_mtim;
+                new_inode->st.st_ctim = host_st.st_ctim;
+                if (new_inode->is_file())
+                    new_inode->st.st_size = host_st.st_size;
             }
         }
         catch (const std::exception &e)
@@ -466,21 +763,45 @@ namespace QuasiFS
 
     int QFS::GetFreeHandleNo()
     {
-        auto open_fd_size = open_fd.size();
-        for (size_t idx = 0; idx < open_fd_size; idx++)
+        while (!free_fd.empty())
         {
-            if (nullptr == this->open_fd[idx])
-                return idx;
+            size_t fd = free_fd.top();
+            free_fd.pop();
+            // stale, slot was trimmed or taken after being freed more than once
+            if (fd < open_fd.size() && !open_fd[fd].IsOpen())
+                return static_cast<int>(fd);
         }
-        open_fd.push_back(nullptr);
-        return open_fd_size;
+
+        // no holes, every slot below the end is taken
+        open_fd.emplace_back();
+        return static_cast<int>(open_fd.size() - 1);
+    }
+
+    void QFS::ReleaseHandleNo(int fd)
+    {
+        open_fd.at(fd) = File{};
+
+        if (static_cast<size_t>(fd) + 1 < open_fd.size())
+        {
+            free_fd.push(fd);
+            return;
+        }
+
+        // if it's the last entry, remove it (and free ones below) to avoid blowing up fd table
+        while (!open_fd.empty() && !open_fd.back().IsOpen())
+            open_fd.pop_back();
+
+        // nothing left to hand out
+        if (open_fd.empty())
+            free_fd = {};
     }
 
     fd_handle_ptr QFS::GetHandle(int fd)
     {
-        if (fd < 0 || fd >= this->open_fd.size())
+        if (fd < 0 || static_cast<size_t>(fd) >= this->open_fd.size())
             return nullptr;
-        return this->open_fd.at(fd);
+        File &handle = this->open_fd[fd];
+        return handle.IsOpen() ? &handle : nullptr;
     }
 
     mount_t *QFS::GetPartitionInfo(const partition_ptr part)
@@ -504,12 +825,9 @@ namespace QuasiFS
 
     partition_ptr QFS::GetPartitionByParent(const dir_ptr dir)
     {
-        for (auto &[part, info] : this->block_devices)
-        {
-            if (info.parentdir == dir)
-                return part;
-        }
-        return nullptr;
+        if (nullptr == dir)
+            return nullptr;
+        return dir->mounted_partition;
     }
 
     int QFS::IsPartitionRO(partition_ptr part)
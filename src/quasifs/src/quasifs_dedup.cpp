@@ -0,0 +1,96 @@
+// INAA License @marecl 2025
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+#include "../quasifs_dedup.h"
+
+namespace QuasiFS
+{
+
+    RegularFile::page_ptr DedupStore::Intern(const RegularFile::page_ptr &page)
+    {
+        if (this->index.size() >= this->prune_threshold)
+        {
+            Prune();
+            this->prune_threshold = std::max<size_t>(1024, this->index.size() * 2);
+        }
+
+        this->lookups++;
+        uint64_t hash = Hash(page->data, RegularFile::PAGE_SIZE);
+
+        auto [first, last] = this->index.equal_range(hash);
+        for (auto it = first; it != last; it++)
+        {
+            RegularFile::page_ptr candidate = it->second.lock();
+            if (nullptr == candidate || page == candidate)
+                continue;
+
+            // pinned by a mapping, writes would bypass copy-on-write
+            if (candidate.use_count() != static_cast<long>(candidate->owners) + 1)
+                continue;
+
+            // collision, or modified since it was indexed
+            if (0 != std::memcmp(candidate->data, page->data, RegularFile::PAGE_SIZE))
+                continue;
+
+            this->hits++;
+            return candidate;
+        }
+
+        this->index.emplace(hash, page);
+        return page;
+    }
+
+    DedupStore::Stats DedupStore::GetStats(void)
+    {
+        Prune();
+
+        Stats stats{this->lookups, this->hits, 0, 0};
+        for (const auto &[hash, entry] : this->index)
+        {
+            RegularFile::page_ptr page = entry.lock();
+            stats.unique_pages++;
+            stats.shared_pages += page->owners;
+        }
+        return stats;
+    }
+
+    void DedupStore::Prune(void)
+    {
+        std::erase_if(this->index, [](const auto &kv)
+                      { return kv.second.expired(); });
+    }
+
+    uint64_t DedupStore::Hash(const char *data, quasi_size_t size)
+    {
+        // four independent multiply-rotate lanes over 8-byte words, folded at the end
+        constexpr uint64_t PRIME_1 = 0x9E3779B185EBCA87ULL;
+        constexpr uint64_t PRIME_2 = 0xC2B2AE3D27D4EB4FULL;
+
+        uint64_t lanes[4]{PRIME_1, PRIME_2, ~PRIME_1, ~PRIME_2};
+        quasi_size_t pos = 0;
+
+        for (; pos + 32 <= size; pos += 32)
+        {
+            for (int lane = 0; lane < 4; lane++)
+            {
+                uint64_t word;
+                std::memcpy(&word, data + pos + lane * 8, sizeof(word));
+                lanes[lane] = std::rotl(lanes[lane] + word * PRIME_2, 31) * PRIME_1;
+            }
+        }
+
+        uint64_t hash = std::rotl(lanes[0], 1) + std::rotl(lanes[1], 7) + std::rotl(lanes[2], 12) + std::rotl(lanes[3], 18);
+        for (; pos < size; pos++)
+            hash = (hash ^ static_cast<uint8_t>(data[pos])) * PRIME_1;
+
+        hash ^= size;
+        hash ^= hash >> 33;
+        hash *= PRIME_2;
+        hash ^= hash >> 29;
+        return hash;
+    }
+
+}
@@ -0,0 +1,117 @@
+// INAA License @marecl 2025
+
+#include "../quasi_errno.h"
+
+#include "../quasifs_dentry_cache.h"
+
+namespace QuasiFS
+{
+
+    DentryCache::DentryCache()
+    {
+        caches.push_back(this);
+    }
+
+    DentryCache::~DentryCache()
+    {
+        std::erase(caches, this);
+    }
+
+    void DentryCache::Invalidate(void)
+    {
+        generation++;
+        // every negative entry is dead anyway
+        negative_index.clear();
+
+        // stale resolutions hold inodes (and partitions) of whatever was just removed
+        for (DentryCache *cache : caches)
+            cache->Clear();
+    }
+
+    void DentryCache::InvalidateNegative(const Directory *parent, const std::string &name)
+    {
+        if (negative_index.empty())
+            return;
+
+        auto it = negative_index.find(NegativeKey{parent, name});
+        if (negative_index.end() == it)
+            return;
+
+        *(it->second) = false;
+        negative_index.erase(it);
+    }
+
+    bool DentryCache::Lookup(const fs::path &path, Resolved &res, int &status)
+    {
+        if (!Validate())
+            return false;
+
+        auto it = entries.find(path.native());
+        if (entries.end() == it)
+            return false;
+
+        Entry &entry = it->second;
+        if (nullptr != entry.valid && !*(entry.valid))
+        {
+            entries.erase(it);
+            return false;
+        }
+
+        res = entry.res;
+        status = entry.status;
+        return true;
+    }
+
+    void DentryCache::Insert(const fs::path &path, const Resolved &res)
+    {
+        Reserve();
+        entries.insert_or_assign(path.native(), Entry{0, res, nullptr});
+    }
+
+    void DentryCache::InsertNegative(const fs::path &path, const Resolved &res)
+    {
+        if (nullptr == res.parent)
+            return;
+
+        Reserve();
+
+        // many paths (symlinks) may end up at the same missing name, they all share validity
+        auto [it, inserted] = negative_index.try_emplace(NegativeKey{res.parent.get(), res.leaf}, nullptr);
+        if (inserted)
+            it->second = std::make_shared<bool>(true);
+
+        entries.insert_or_assign(path.native(), Entry{-QUASI_ENOENT, res, it->second});
+    }
+
+    void DentryCache::Clear(void)
+    {
+        // invalidation storms shouldn't wipe bucket arrays of empty caches over and over
+        if (!entries.empty())
+            entries.clear();
+        cached_generation = generation;
+    }
+
+    bool DentryCache::Validate(void)
+    {
+        if (cached_generation == generation)
+            return true;
+
+        Clear();
+        return false;
+    }
+
+    void DentryCache::Reserve(void)
+    {
+        Validate();
+
+        // no LRU, working set is expected to be way smaller than the limit
+        if (entries.size() < MAX_ENTRIES)
+            return;
+
+        entries.clear();
+
+        // drop names nobody is waiting for anymore
+        std::erase_if(negative_index, [](const auto &kv)
+                      { return kv.second.use_count() == 1; });
+    }
+}
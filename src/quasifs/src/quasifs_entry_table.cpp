@@ -0,0 +1,158 @@
+// INAA License @marecl 2025
+
+#include <algorithm>
+#include <bit>
+
+#include "../quasifs_entry_table.h"
+
+namespace QuasiFS
+{
+
+    inode_ptr EntryTable::find(std::string_view name) const
+    {
+        size_t slot = FindSlot(name, Hash(name));
+        if (EMPTY_SLOT == slot)
+            return nullptr;
+        return dense[index[slot]].second;
+    }
+
+    bool EntryTable::insert(const std::string &name, inode_ptr node)
+    {
+        const size_t hash = Hash(name);
+        if (EMPTY_SLOT != FindSlot(name, hash))
+            return false;
+
+        // keep load factor under 3/4, tombstones don't take index slots
+        if ((this->live + 1) * 4 > index.size() * 3)
+            Rehash(std::max(MIN_CAPACITY, index.size() * 2));
+
+        const size_t mask = index.size() - 1;
+        size_t slot = hash & mask;
+        while (EMPTY_SLOT != index[slot])
+            slot = (slot + 1) & mask;
+
+        // lowest free position past the end means every one of them was trimmed
+        if (!free_positions.empty() && free_positions.top() >= dense.size())
+            free_positions = {};
+
+        if (free_positions.empty())
+        {
+            index[slot] = static_cast<uint32_t>(dense.size());
+            dense.emplace_back(name, std::move(node));
+            hashes.push_back(hash);
+        }
+        else
+        {
+            uint32_t pos = free_positions.top();
+            free_positions.pop();
+            index[slot] = pos;
+            dense[pos] = value_type(name, std::move(node));
+            hashes[pos] = hash;
+        }
+        this->live++;
+        return true;
+    }
+
+    bool EntryTable::erase(std::string_view name)
+    {
+        size_t slot = FindSlot(name, Hash(name));
+        if (EMPTY_SLOT == slot)
+            return false;
+
+        // tombstone, positions of other entries stay the same
+        value_type &entry = dense[index[slot]];
+        entry.first.clear();
+        entry.second = nullptr;
+        free_positions.push(index[slot]);
+        this->live--;
+
+        // backward shift deletion, no tombstones in the index
+        const size_t mask = index.size() - 1;
+        size_t hole = slot;
+        size_t next = (hole + 1) & mask;
+        while (EMPTY_SLOT != index[next])
+        {
+            size_t home = hashes[index[next]] & mask;
+            // move back only if [next] doesn't have to stay between its home and the hole
+            if (((next - home) & mask) >= ((next - hole) & mask))
+            {
+                index[hole] = index[next];
+                hole = next;
+            }
+            next = (next + 1) & mask;
+        }
+        index[hole] = EMPTY_SLOT;
+
+        Compact();
+        return true;
+    }
+
+    void EntryTable::clear(void)
+    {
+        // no cursor can point into an empty table, memory goes back too
+        dense = {};
+        hashes = {};
+        index = {};
+        free_positions = {};
+        this->live = 0;
+    }
+
+    void EntryTable::Compact(void)
+    {
+        if (0 == this->live)
+        {
+            clear();
+            return;
+        }
+
+        // positions below the last entry have to stay, cursors may point there
+        while (nullptr == dense.back().second)
+        {
+            dense.pop_back();
+            hashes.pop_back();
+        }
+
+        if (!free_positions.empty() && free_positions.top() >= dense.size())
+            free_positions = {};
+
+        // shrink at 1/8 load, back to 1/2 so insertions don't grow it right away
+        if (index.size() > MIN_CAPACITY && this->live * 8 < index.size())
+        {
+            Rehash(std::max(MIN_CAPACITY, std::bit_ceil(this->live * 2)));
+            dense.shrink_to_fit();
+            hashes.shrink_to_fit();
+        }
+    }
+
+    size_t EntryTable::FindSlot(std::string_view name, size_t hash) const
+    {
+        if (index.empty())
+            return EMPTY_SLOT;
+
+        const size_t mask = index.size() - 1;
+        for (size_t slot = hash & mask;; slot = (slot + 1) & mask)
+        {
+            uint32_t pos = index[slot];
+            if (EMPTY_SLOT == pos)
+                return EMPTY_SLOT;
+            if (hashes[pos] == hash && dense[pos].first == name)
+                return slot;
+        }
+    }
+
+    void EntryTable::Rehash(size_t capacity)
+    {
+        index.assign(capacity, EMPTY_SLOT);
+        const size_t mask = capacity - 1;
+        for (size_t pos = 0; pos < dense.size(); pos++)
+        {
+            if (nullptr == dense[pos].second)
+                continue;
+            size_t slot = hashes[pos] & mask;
+            while (EMPTY_SLOT != index[slot])
+                slot = (slot + 1) & mask;
+            index[slot] = static_cast<uint32_t>(pos);
+        }
+    }
+
+}
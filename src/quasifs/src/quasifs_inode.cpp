@@ -0,0 +1,15 @@
+// INAA License @marecl 2025
+
+#include "../quasifs_inode.h"
+#include "../quasifs_partition.h"
+
+namespace QuasiFS
+{
+
+    Inode::~Inode()
+    {
+        if (partition_ptr part = this->owner.lock(); nullptr != part)
+            part->ReleaseFileno(this->fileno);
+    }
+
+}
@@ -1,8 +1,10 @@
 // INAA License @marecl 2025
 
-#include <map>
+#include <cstddef>
+#include <cstring>
 #include <string>
 
+#include "../quasifs_dentry_cache.h"
 #include "../quasifs_inode_directory.h"
 
 namespace QuasiFS
@@ -14,41 +16,116 @@ namespace QuasiFS
         st.st_nlink = 0;
     }
 
-    inode_ptr Directory::lookup(const std::string &name)
+    quasi_ssize_t Directory::getdents(void *buf, quasi_size_t nbytes, quasi_off_t *basep)
     {
-        auto it = entries.find(name);
-        if (it == entries.end())
-            return nullptr;
-        return it->second;
+        if (nullptr == buf || nullptr == basep || *basep < 0)
+            return -QUASI_EINVAL;
+
+        char *out = static_cast<char *>(buf);
+        quasi_size_t written = 0;
+        size_t pos = *basep;
+
+        // entry table positions are shifted by synthesized "." and ".."
+        for (; pos < RELATIVE_ENTRIES + entries.positions(); pos++)
+        {
+            std::string_view name;
+            const Inode *node;
+
+            if (pos < RELATIVE_ENTRIES)
+            {
+                name = 0 == pos ? "." : "..";
+                // only compared and numbered, nothing gets dropped while we are here
+                node = 0 == pos ? this->self.lock().get() : this->parent.lock().get();
+            }
+            else
+            {
+                const auto &entry = entries.at(pos - RELATIVE_ENTRIES);
+                name = entry.first;
+                node = entry.second.get();
+            }
+
+            if (nullptr == node)
+                continue;
+
+            const quasi_size_t reclen = dirent_size(name.size());
+
+            if (written + reclen > nbytes)
+            {
+                // not even a single record fits
+                if (0 == written)
+                    return -QUASI_EINVAL;
+                break;
+            }
+
+            // dirent_t is packed, so records don't care about buffer alignment
+            // only the header and the name are written, record never spans whole d_name
+            dirent_t *record = reinterpret_cast<dirent_t *>(out + written);
+            record->d_ino = node->st.st_ino;
+            // cursor of the next record, can be used to resume (lseek) right after this one
+            record->d_off = pos + 1;
+            record->d_reclen = reclen;
+            // DT_* values are the same as S_IFMT bits
+            record->d_type = (node->st.st_mode & QUASI_S_IFMT) >> 12;
+            memcpy(record->d_name, name.data(), name.size());
+            memset(record->d_name + name.size(), 0, reclen - offsetof(dirent_t, d_name) - name.size());
+
+            written += reclen;
+        }
+
+        *basep = pos;
+        return written;
+    }
+
+    inode_ptr Directory::lookup(std::string_view name)
+    {
+        if (is_relative_name(name))
+            return "." == name ? this->self.lock() : this->parent.lock();
+        return entries.find(name);
     }
 
     int Directory::link(const std::string &name, inode_ptr child)
     {
         if (name.empty())
             return -QUASI_ENOENT;
-        if (entries.count(name))
+        // null inode marks removed entry
+        if (nullptr == child)
+            return -QUASI_EINVAL;
+        if (is_relative_name(name))
+            return -QUASI_EEXIST;
+        if (!entries.insert(name, child))
             return -QUASI_EEXIST;
-        entries[name] = child;
         if (!child->is_link())
             child->st.st_nlink++;
+        account(name, child, 1);
+        // new name can't change existing resolutions, only the ones that missed it
+        DentryCache::InvalidateNegative(this, name);
         return 0;
     }
 
+    void Directory::link_relatives(const dir_ptr &self, const dir_ptr &parent)
+    {
+        self->self = self;
+        self->parent = parent;
+
+        self->st.st_nlink++;
+        self->account(".", self, 1);
+        parent->st.st_nlink++;
+        self->account("..", parent, 1);
+    }
+
     int Directory::unlink(const std::string &name)
     {
-        auto it = entries.find(name);
-        if (it == entries.end())
+        if (is_relative_name(name))
+            return -QUASI_EINVAL;
+
+        inode_ptr target = entries.find(name);
+        if (nullptr == target)
             return -QUASI_ENOENT;
 
-        inode_ptr target = it->second;
         // if directory and not empty -> EBUSY or ENOTEMPTY
         if (target->is_dir())
         {
-            dir_ptr dir = std::static_pointer_cast<Directory>(target);
-            auto children = dir->list();
-            children.erase(std::remove(children.begin(), children.end(), "."), children.end());
-            children.erase(std::remove(children.begin(), children.end(), ".."), children.end());
-            if (!children.empty())
+            if (!std::static_pointer_cast<Directory>(target)->is_empty())
                 return -QUASI_ENOTEMPTY;
 
             // parent loses reference from subdir [ .. ]
@@ -59,13 +136,44 @@ namespace QuasiFS
 
         // not referenced in original location anymore
         target->st.st_nlink--;
-        entries.erase(it);
+        account(name, target, -1);
+        entries.erase(name);
+        DentryCache::Invalidate();
         return 0;
     }
 
+    quasi_size_t Directory::dirent_size(size_t name_length)
+    {
+        // header + name + NUL, records are 8-byte aligned (same as linux_dirent64)
+        return (offsetof(dirent_t, d_name) + name_length + 1 + 7) & ~static_cast<quasi_size_t>(7);
+    }
+
+    void Directory::account(const std::string &name, const inode_ptr &child, int delta)
+    {
+        this->st.st_size += delta * static_cast<quasi_off_t>(dirent_size(name.size()));
+
+        if (is_relative_name(name))
+            return;
+
+        if (child->is_file())
+            counts.files += delta;
+        else if (child->is_dir())
+            counts.dirs += delta;
+        else if (child->is_link())
+            counts.links += delta;
+        else if (child->is_char())
+            counts.devices += delta;
+        else
+            counts.other += delta;
+    }
+
     std::vector<std::string> Directory::list()
     {
         std::vector<std::string> r;
+        if (nullptr != this->self.lock())
+            r.push_back(".");
+        if (nullptr != this->parent.lock())
+            r.push_back("..");
         for (auto &p : entries)
             r.push_back(p.first);
         return r;
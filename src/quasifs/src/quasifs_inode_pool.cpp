@@ -0,0 +1,55 @@
+// INAA License @marecl 2025
+
+#include <new>
+
+#include "../quasifs_inode_pool.h"
+
+namespace QuasiFS
+{
+
+    InodePool::~InodePool()
+    {
+        for (void *chunk : this->chunks)
+            ::operator delete(chunk, std::align_val_t{SLOT_ALIGN});
+    }
+
+    void *InodePool::Allocate(size_t size)
+    {
+        if (size > MAX_SLOT)
+            return ::operator new(size, std::align_val_t{SLOT_ALIGN});
+
+        size_t size_class = SizeClass(size);
+        if (void *slot = this->free_lists[size_class]; nullptr != slot)
+        {
+            this->free_lists[size_class] = *static_cast<void **>(slot);
+            return slot;
+        }
+
+        size_t slot_size = (size_class + 1) * SLOT_ALIGN;
+        if (static_cast<size_t>(this->bump_end - this->bump) < slot_size)
+        {
+            // tail of the previous chunk is wasted, at most MAX_SLOT bytes
+            this->bump = static_cast<char *>(::operator new(CHUNK_SIZE, std::align_val_t{SLOT_ALIGN}));
+            this->bump_end = this->bump + CHUNK_SIZE;
+            this->chunks.push_back(this->bump);
+        }
+
+        void *slot = this->bump;
+        this->bump += slot_size;
+        return slot;
+    }
+
+    void InodePool::Deallocate(void *ptr, size_t size)
+    {
+        if (size > MAX_SLOT)
+        {
+            ::operator delete(ptr, std::align_val_t{SLOT_ALIGN});
+            return;
+        }
+
+        size_t size_class = SizeClass(size);
+        *static_cast<void **>(ptr) = this->free_lists[size_class];
+        this->free_lists[size_class] = ptr;
+    }
+
+}
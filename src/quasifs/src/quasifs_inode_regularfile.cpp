@@ -1,8 +1,13 @@
 // INAA License @marecl 2025
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
 #include <vector>
 
+#include "../quasifs_dedup.h"
 #include "../quasifs_inode_regularfile.h"
+#include "../quasifs_lz.h"
 
 namespace QuasiFS
 {
@@ -11,21 +16,54 @@ namespace QuasiFS
     {
         st.st_mode = 0000755 | QUASI_S_IFREG;
         st.st_nlink = 0;
+        st.st_blksize = PAGE_SIZE;
+        st.st_blocks = 0;
+    }
+
+    RegularFile::~RegularFile()
+    {
+        // clones must know they're the only owner now
+        for (page_ptr &page : this->pages)
+            ReleasePage(page);
+        DropPacked();
     }
 
     quasi_ssize_t RegularFile::read(quasi_off_t offset, void *buf, quasi_size_t count)
     {
-        quasi_ssize_t idx;
-        quasi_off_t read_amt = this->data.size() - offset - count;
+        if (offset < 0)
+            return -QUASI_EINVAL;
+
+        this->idle_sweeps = 0;
+
+        quasi_size_t size = this->st.st_size;
+        if (static_cast<quasi_size_t>(offset) >= size)
+            return 0;
+
+        // short read at EOF
+        quasi_size_t read_amt = std::min(count, size - offset);
+
+        if (IsInline())
+        {
+            std::memcpy(buf, this->inline_data + offset, read_amt);
+            return read_amt;
+        }
 
-        // if >= 0 - we're good to go
-        // <0 - n-bytes are missing, won't enter loop
-        read_amt = count + read_amt * (read_amt < 0);
+        quasi_size_t pos = offset;
+        char *dst = static_cast<char *>(buf);
 
-        for (idx = 0; idx < read_amt; idx++)
+        for (quasi_size_t remaining = read_amt; remaining > 0;)
         {
-            char c = this->data.at(idx + offset);
-            static_cast<char *>(buf)[idx] = c;
+            quasi_size_t page_offset = pos % PAGE_SIZE;
+            quasi_size_t amt = std::min(remaining, PAGE_SIZE - page_offset);
+
+            if (const char *page = ReadablePage(pos / PAGE_SIZE); nullptr != page)
+                std::memcpy(dst, page + page_offset, amt);
+            else
+                std::memset(dst, 0, amt);
+
+            dst += amt;
+            pos += amt;
+            remaining -= amt;
         }
 
         return read_amt;
@@ -33,15 +71,46 @@ namespace QuasiFS
 
     quasi_ssize_t RegularFile::write(quasi_off_t offset, const void *buf, quasi_size_t count)
     {
-        auto size = &this->st.st_size;
-        auto end_pos = offset + count;
-        *size = end_pos > *size ? end_pos : *size;
+        if (offset < 0)
+            return -QUASI_EINVAL;
+
+        this->idle_sweeps = 0;
 
-        // size can only be greater, so it will always scale up
-        this->data.resize(*size, 0);
+        quasi_size_t end_pos = offset + count;
 
-        for (quasi_off_t idx = offset; idx < *size; idx++)
-            this->data[idx] = static_cast<const char *>(buf)[idx];
+        if (IsInline() && end_pos <= INLINE_SIZE)
+        {
+            std::memcpy(this->inline_data + offset, buf, count);
+            if (end_pos > static_cast<quasi_size_t>(this->st.st_size))
+                this->st.st_size = end_pos;
+            return count;
+        }
+
+        SpillInline();
+
+        // only page table grows, existing pages stay where they are
+        if (PageCount(end_pos) > this->pages.size())
+            this->pages.resize(PageCount(end_pos));
+        if (end_pos > static_cast<quasi_size_t>(this->st.st_size))
+            this->st.st_size = end_pos;
+
+        quasi_size_t pos = offset;
+        const char *src = static_cast<const char *>(buf);
+
+        for (quasi_size_t remaining = count; remaining > 0;)
+        {
+            quasi_size_t page_offset = pos % PAGE_SIZE;
+            quasi_size_t amt = std::min(remaining, PAGE_SIZE - page_offset);
+
+            // writing zeros into a hole changes nothing
+            if (!IsHole(pos / PAGE_SIZE) || std::any_of(src, src + amt, [](char c)
+                                                        { return 0 != c; }))
+                std::memcpy(WritablePage(pos / PAGE_SIZE) + page_offset, src, amt);
+
+            src += amt;
+            pos += amt;
+            remaining -= amt;
+        }
 
         return count;
     }
@@ -50,25 +119,296 @@ namespace QuasiFS
     {
         if (length < 0)
             return -QUASI_EINVAL;
-        this->data.resize(length, 0);
+
+        this->idle_sweeps = 0;
+
+        quasi_size_t new_size = length;
+
+        if (IsInline() && new_size <= INLINE_SIZE)
+        {
+            if (new_size < static_cast<quasi_size_t>(this->st.st_size))
+                std::memset(this->inline_data + new_size, 0, this->st.st_size - new_size);
+            this->st.st_size = length;
+            return 0;
+        }
+
+        SpillInline();
+
+        if (new_size < static_cast<quasi_size_t>(this->st.st_size))
+        {
+            // tail of the last page must read back as zeros if file grows again
+            quasi_size_t page_offset = new_size % PAGE_SIZE;
+            if (0 != page_offset && !IsHole(new_size / PAGE_SIZE))
+                std::memset(WritablePage(new_size / PAGE_SIZE) + page_offset, 0, PAGE_SIZE - page_offset);
+        }
+
+        for (quasi_size_t page_idx = PageCount(new_size); page_idx < this->pages.size(); page_idx++)
+            ReleasePage(this->pages[page_idx]);
+        DropPacked(PageCount(new_size));
+
+        this->pages.resize(PageCount(new_size));
         this->st.st_size = length;
         return 0;
     }
 
+    int RegularFile::clone(const RegularFile &src)
+    {
+        if (this == &src)
+            return 0;
+
+        if (src.writable_maps > 0)
+            return -QUASI_EBUSY;
+
+        for (page_ptr &page : this->pages)
+            ReleasePage(page);
+        DropPacked();
+
+        // zeroed for paged [src], same as any paged file
+        std::memcpy(this->inline_data, src.inline_data, INLINE_SIZE);
+
+        // copy of the page table only
+        this->pages = src.pages;
+        for (page_ptr &page : this->pages)
+            if (nullptr != page)
+                page->owners++;
+
+        // compressed data is immutable, so it's shared as it is
+        if (nullptr != src.packed)
+        {
+            this->packed = std::make_unique<PackedPages>(*src.packed);
+            for (const auto &[page_idx, data] : this->packed->pages)
+            {
+                this->packed->stats->original_bytes += PAGE_SIZE;
+                this->packed->stats->packed_bytes += data->size();
+            }
+        }
+
+        this->st.st_size = src.st.st_size;
+        this->st.st_blocks = src.st.st_blocks;
+        return 0;
+    }
+
+    quasi_off_t RegularFile::lseek(quasi_off_t offset, QuasiFS::SeekOrigin origin)
+    {
+        if (SeekOrigin::DATA != origin && SeekOrigin::HOLE != origin)
+            return -QUASI_EINVAL;
+
+        if (offset < 0)
+            return -QUASI_EINVAL;
+
+        quasi_size_t size = this->st.st_size;
+        if (static_cast<quasi_size_t>(offset) >= size)
+            return -QUASI_ENXIO;
+
+        bool want_hole = SeekOrigin::HOLE == origin;
+
+        // inline contents are data, whatever they are
+        if (IsInline())
+            return want_hole ? size : offset;
+
+        quasi_size_t page_count = PageCount(size);
+
+        for (quasi_size_t page_idx = offset / PAGE_SIZE; page_idx < page_count; page_idx++)
+        {
+            if (IsHole(page_idx) != want_hole)
+                continue;
+            return std::max<quasi_size_t>(offset, page_idx * PAGE_SIZE);
+        }
+
+        // no data till EOF, or implicit hole at EOF
+        return want_hole ? size : -QUASI_ENXIO;
+    }
+
+    char *RegularFile::WritablePage(quasi_size_t page_idx)
+    {
+        page_ptr &page = this->pages[page_idx];
+        this->dedup_pending = true;
+
+        if (nullptr == page && IsPacked(page_idx))
+            UnpackPage(page_idx);
+
+        if (nullptr == page)
+        {
+            // zeroed
+            page = std::make_shared<Page>();
+            this->st.st_blocks += BLOCKS_PER_PAGE;
+        }
+        else if (page->owners > 1)
+        {
+            page_ptr copy = std::make_shared_for_overwrite<Page>();
+            std::memcpy(copy->data, page->data, PAGE_SIZE);
+            page->owners--;
+            page = std::move(copy);
+        }
+
+        return page->data;
+    }
+
+    void RegularFile::SpillInline(bool force)
+    {
+        if (!this->pages.empty())
+            return;
+
+        // nothing but zeros, hole does the same
+        if (!force && std::all_of(this->inline_data, this->inline_data + INLINE_SIZE, [](char c)
+                        { return 0 == c; }))
+            return;
+
+        this->pages.resize(1);
+        std::memcpy(WritablePage(0), this->inline_data, INLINE_SIZE);
+        std::memset(this->inline_data, 0, INLINE_SIZE);
+    }
+
+    const char *RegularFile::ReadablePage(quasi_size_t page_idx)
+    {
+        if (page_idx >= this->pages.size())
+            return nullptr;
+
+        if (nullptr == this->pages[page_idx] && IsPacked(page_idx))
+            UnpackPage(page_idx);
+
+        return nullptr == this->pages[page_idx] ? nullptr : this->pages[page_idx]->data;
+    }
+
+    quasi_size_t RegularFile::sweep(uint32_t idle_limit, const compression_stats_ptr &stats)
+    {
+        // compressed once per idle period, pages that don't compress aren't retried every sweep
+        if (0 == idle_limit || this->idle_sweeps >= idle_limit)
+            return 0;
+        if (++this->idle_sweeps < idle_limit)
+            return 0;
+
+        quasi_size_t packed_count = 0;
+        std::unique_ptr<char[]> scratch{};
+
+        for (quasi_size_t page_idx = 0; page_idx < this->pages.size(); page_idx++)
+        {
+            page_ptr &page = this->pages[page_idx];
+
+            // shared with a clone or pinned by a mapping
+            if (nullptr == page || 1 != page.use_count())
+                continue;
+
+            if (nullptr == scratch)
+                scratch = std::make_unique_for_overwrite<char[]>(MAX_PACKED_SIZE);
+
+            quasi_size_t packed_size = LZ::Compress(page->data, PAGE_SIZE, scratch.get(), MAX_PACKED_SIZE);
+            if (0 == packed_size)
+                continue;
+
+            if (nullptr == this->packed)
+                this->packed = std::make_unique<PackedPages>();
+            if (nullptr == this->packed->stats)
+                this->packed->stats = stats;
+
+            this->packed->pages[page_idx] = std::make_shared<const std::vector<char>>(scratch.get(), scratch.get() + packed_size);
+            this->packed->stats->pages_packed++;
+            this->packed->stats->original_bytes += PAGE_SIZE;
+            this->packed->stats->packed_bytes += packed_size;
+
+            // not released, page still counts towards st_blocks
+            page.reset();
+            packed_count++;
+        }
+
+        return packed_count;
+    }
+
+    quasi_size_t RegularFile::dedup(DedupStore &store)
+    {
+        if (!this->dedup_pending)
+            return 0;
+
+        quasi_size_t shared_count = 0;
+        for (page_ptr &page : this->pages)
+        {
+            // already shared, or pinned by a mapping
+            if (nullptr == page || 1 != page.use_count())
+                continue;
+
+            page_ptr existing = store.Intern(page);
+            if (existing == page)
+                continue;
+
+            existing->owners++;
+            page = std::move(existing);
+            shared_count++;
+        }
+
+        // pages mapped for writing were skipped and may still change
+        this->dedup_pending = this->writable_maps > 0;
+        return shared_count;
+    }
+
+    void RegularFile::UnpackPage(quasi_size_t page_idx)
+    {
+        auto start = std::chrono::steady_clock::now();
+
+        auto it = this->packed->pages.find(page_idx);
+        const std::vector<char> &data = *it->second;
+
+        page_ptr page = std::make_shared_for_overwrite<Page>();
+        LZ::Decompress(data.data(), data.size(), page->data, PAGE_SIZE);
+        this->pages[page_idx] = std::move(page);
+
+        CompressionStats &stats = *this->packed->stats;
+        stats.original_bytes -= PAGE_SIZE;
+        stats.packed_bytes -= data.size();
+        this->packed->pages.erase(it);
+
+        uint64_t ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+        stats.pages_unpacked++;
+        stats.unpack_ns += ns;
+        stats.unpack_max_ns = std::max(stats.unpack_max_ns, ns);
+    }
+
+    void RegularFile::DropPacked(quasi_size_t first_page_idx)
+    {
+        if (nullptr == this->packed)
+            return;
+
+        std::erase_if(this->packed->pages, [&](const auto &kv)
+                      {
+                          if (kv.first < first_page_idx)
+                              return false;
+                          this->packed->stats->original_bytes -= PAGE_SIZE;
+                          this->packed->stats->packed_bytes -= kv.second->size();
+                          this->st.st_blocks -= BLOCKS_PER_PAGE;
+                          return true; });
+    }
+
+    void RegularFile::ReleasePage(page_ptr &page)
+    {
+        if (nullptr == page)
+            return;
+
+        page->owners--;
+        page.reset();
+        this->st.st_blocks -= BLOCKS_PER_PAGE;
+    }
+
     quasi_ssize_t RegularFile::MockRead(quasi_off_t offset, void *buf, quasi_size_t count)
     {
-        auto size = &this->st.st_size;
-        auto end_pos = offset + count;
+        if (offset < 0)
+            return -QUASI_EINVAL;
+
+        quasi_size_t size = this->st.st_size;
+        if (static_cast<quasi_size_t>(offset) >= size)
+            return 0;
 
-        return end_pos > *size ? *size - offset : count;
+        return std::min(count, size - offset);
     }
 
     quasi_ssize_t RegularFile::MockWrite(quasi_off_t offset, const void *buf, quasi_size_t count)
     {
-        auto size = &this->st.st_size;
-        auto end_pos = offset + count;
+        if (offset < 0)
+            return -QUASI_EINVAL;
 
-        *size = end_pos > *size ? end_pos : *size;
+        quasi_size_t end_pos = offset + count;
+        if (end_pos > INLINE_SIZE)
+            SpillInline();
+        if (end_pos > static_cast<quasi_size_t>(this->st.st_size))
+            this->st.st_size = end_pos;
 
         return count;
     }
@@ -77,6 +417,13 @@ namespace QuasiFS
     {
         if (length < 0)
             return -QUASI_EINVAL;
+
+        quasi_size_t new_size = length;
+        if (new_size > INLINE_SIZE)
+            SpillInline();
+        else if (IsInline() && new_size < static_cast<quasi_size_t>(this->st.st_size))
+            std::memset(this->inline_data + new_size, 0, this->st.st_size - new_size);
+
         this->st.st_size = length;
         return 0;
     }
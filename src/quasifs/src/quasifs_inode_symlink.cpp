@@ -1,14 +1,15 @@
 // INAA License @marecl 2025
 
+#include "../quasifs_dentry_cache.h"
 #include "../quasifs_inode_symlink.h"
 
 namespace QuasiFS
 {
 
-    Symlink::Symlink(fs::path target) : target(target)
+    Symlink::Symlink(fs::path target) : target(target.native())
     {
         // fileno and blkdev assigned by partition
-        this->st.st_size = target.string().size();
+        this->st.st_size = this->target.size();
         this->st.st_mode = 0000755 | QUASI_S_IFLNK;
         this->st.st_nlink = 0;
         // not incrementing target, this type is a softlink
@@ -18,4 +19,49 @@ namespace QuasiFS
     {
         return target;
     }
-}
\ No newline at end of file
+
+    bool Symlink::LookupTarget(const dir_ptr &root, Resolved &res, std::string_view &local_path)
+    {
+        if (!this->has_cached_target)
+            return false;
+
+        // resolved by someone else, it's still valid for them
+        if (this->cached_target.root.lock() != root)
+            return false;
+
+        if (DentryCache::Generation() != this->cached_target.generation)
+        {
+            this->has_cached_target = false;
+            return false;
+        }
+
+        partition_ptr mountpoint = this->cached_target.mountpoint.lock();
+        dir_ptr parent = this->cached_target.parent.lock();
+        inode_ptr node = this->cached_target.node.lock();
+
+        if (nullptr == mountpoint || nullptr == parent || nullptr == node)
+        {
+            this->has_cached_target = false;
+            return false;
+        }
+
+        res.mountpoint = std::move(mountpoint);
+        res.parent = std::move(parent);
+        res.node = std::move(node);
+        res.leaf = this->cached_target.leaf;
+        local_path = this->cached_target.local_path;
+        return true;
+    }
+
+    void Symlink::CacheTarget(const dir_ptr &root, const Resolved &res)
+    {
+        this->cached_target.generation = DentryCache::Generation();
+        this->cached_target.root = root;
+        this->cached_target.mountpoint = res.mountpoint;
+        this->cached_target.parent = res.parent;
+        this->cached_target.node = res.node;
+        this->cached_target.local_path = res.local_path.native();
+        this->cached_target.leaf = res.leaf;
+        this->has_cached_target = true;
+    }
+}
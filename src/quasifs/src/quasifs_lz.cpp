@@ -0,0 +1,199 @@
+// INAA License @marecl 2025
+
+#include <algorithm>
+#include <cstring>
+
+#include "../quasi_errno.h"
+
+#include "../quasifs_lz.h"
+
+namespace QuasiFS::LZ
+{
+
+    static constexpr quasi_size_t MIN_MATCH = 4;
+    static constexpr quasi_size_t MAX_OFFSET = 65535;
+    // length that spills into 255-runs
+    static constexpr quasi_size_t LENGTH_MASK = 15;
+    static constexpr int HASH_BITS = 12;
+    // short copies are done in fixed-size chunks when both buffers have this much slack
+    static constexpr quasi_size_t WILD_COPY = 16;
+
+    static uint32_t Read32(const char *ptr)
+    {
+        uint32_t value;
+        std::memcpy(&value, ptr, sizeof(value));
+        return value;
+    }
+
+    static uint32_t Hash(uint32_t value)
+    {
+        return (value * 2654435761U) >> (32 - HASH_BITS);
+    }
+
+    static bool PutLength(char *&op, const char *oend, quasi_size_t length)
+    {
+        for (; length >= 255; length -= 255)
+        {
+            if (op >= oend)
+                return false;
+            *op++ = static_cast<char>(255);
+        }
+
+        if (op >= oend)
+            return false;
+        *op++ = static_cast<char>(length);
+        return true;
+    }
+
+    static bool GetLength(const char *&ip, const char *iend, quasi_size_t &length)
+    {
+        uint8_t byte;
+        do
+        {
+            if (ip >= iend)
+                return false;
+            byte = static_cast<uint8_t>(*ip++);
+            length += byte;
+        } while (255 == byte);
+        return true;
+    }
+
+    // [match_length] 0 - last sequence, literals only
+    static bool PutSequence(char *&op, const char *oend, const char *literals, quasi_size_t literal_length, quasi_size_t offset, quasi_size_t match_length)
+    {
+        if (op >= oend)
+            return false;
+
+        char *token = op++;
+        uint8_t token_value = std::min(literal_length, LENGTH_MASK) << 4;
+
+        if (literal_length >= LENGTH_MASK && !PutLength(op, oend, literal_length - LENGTH_MASK))
+            return false;
+        if (literal_length > static_cast<quasi_size_t>(oend - op))
+            return false;
+        std::memcpy(op, literals, literal_length);
+        op += literal_length;
+
+        if (0 != match_length)
+        {
+            if (oend - op < 2)
+                return false;
+            *op++ = static_cast<char>(offset & 0xFF);
+            *op++ = static_cast<char>(offset >> 8);
+
+            quasi_size_t extra = match_length - MIN_MATCH;
+            token_value |= std::min(extra, LENGTH_MASK);
+            if (extra >= LENGTH_MASK && !PutLength(op, oend, extra - LENGTH_MASK))
+                return false;
+        }
+
+        *token = static_cast<char>(token_value);
+        return true;
+    }
+
+    quasi_size_t Compress(const char *src, quasi_size_t src_size, char *dst, quasi_size_t dst_capacity)
+    {
+        // positions within [src], stale or colliding entries are caught by comparing contents
+        uint32_t table[1 << HASH_BITS]{};
+
+        const char *ip = src;
+        const char *anchor = src;
+        const char *iend = src + src_size;
+        char *op = dst;
+        const char *oend = dst + dst_capacity;
+
+        while (static_cast<quasi_size_t>(iend - ip) >= MIN_MATCH)
+        {
+            uint32_t sequence = Read32(ip);
+            uint32_t &slot = table[Hash(sequence)];
+            const char *ref = src + slot;
+            slot = static_cast<uint32_t>(ip - src);
+
+            if (ref >= ip || static_cast<quasi_size_t>(ip - ref) > MAX_OFFSET || Read32(ref) != sequence)
+            {
+                // skip faster through data that doesn't compress
+                ip += std::min<quasi_size_t>(1 + ((ip - anchor) >> 6), iend - ip);
+                continue;
+            }
+
+            quasi_size_t offset = ip - ref;
+            const char *match_end = ip + MIN_MATCH;
+            for (ref += MIN_MATCH; match_end < iend && *match_end == *ref; ref++)
+                match_end++;
+
+            if (!PutSequence(op, oend, anchor, ip - anchor, offset, match_end - ip))
+                return 0;
+
+            ip = anchor = match_end;
+        }
+
+        if (!PutSequence(op, oend, anchor, iend - anchor, 0, 0))
+            return 0;
+
+        return op - dst;
+    }
+
+    quasi_ssize_t Decompress(const char *src, quasi_size_t src_size, char *dst, quasi_size_t dst_capacity)
+    {
+        const char *ip = src;
+        const char *iend = src + src_size;
+        char *op = dst;
+        const char *oend = dst + dst_capacity;
+
+        while (ip < iend)
+        {
+            uint8_t token = static_cast<uint8_t>(*ip++);
+
+            quasi_size_t literal_length = token >> 4;
+            if (LENGTH_MASK == literal_length && !GetLength(ip, iend, literal_length))
+                return -QUASI_EINVAL;
+            if (literal_length > static_cast<quasi_size_t>(iend - ip) || literal_length > static_cast<quasi_size_t>(oend - op))
+                return -QUASI_EINVAL;
+            if (literal_length <= WILD_COPY && iend - ip >= static_cast<quasi_ssize_t>(WILD_COPY) && oend - op >= static_cast<quasi_ssize_t>(WILD_COPY))
+                std::memcpy(op, ip, WILD_COPY);
+            else
+                std::memcpy(op, ip, literal_length);
+            ip += literal_length;
+            op += literal_length;
+
+            // last sequence
+            if (ip == iend)
+                break;
+
+            if (iend - ip < 2)
+                return -QUASI_EINVAL;
+            quasi_size_t offset = static_cast<uint8_t>(ip[0]) | (static_cast<uint8_t>(ip[1]) << 8);
+            ip += 2;
+
+            quasi_size_t match_length = token & LENGTH_MASK;
+            if (LENGTH_MASK == match_length && !GetLength(ip, iend, match_length))
+                return -QUASI_EINVAL;
+            match_length += MIN_MATCH;
+
+            if (0 == offset || offset > static_cast<quasi_size_t>(op - dst) || match_length > static_cast<quasi_size_t>(oend - op))
+                return -QUASI_EINVAL;
+
+            const char *ref = op - offset;
+            if (offset >= 8 && match_length <= WILD_COPY && oend - op >= static_cast<quasi_ssize_t>(WILD_COPY))
+            {
+                // 8-byte steps never read what they write
+                std::memcpy(op, ref, 8);
+                std::memcpy(op + 8, ref + 8, 8);
+            }
+            else if (offset >= match_length)
+                std::memcpy(op, ref, match_length);
+            else
+                // overlapping, repeats last [offset] bytes; whole periods are copied, doubling each time
+                for (quasi_size_t done = 0; done < match_length;)
+                {
+                    quasi_size_t amt = std::min(offset + done, match_length - done);
+                    std::memcpy(op + done, ref, amt);
+                    done += amt;
+                }
+            op += match_length;
+        }
+
+        return op - dst;
+    }
+
+}
@@ -0,0 +1,154 @@
+// INAA License @marecl 2025
+
+#include <algorithm>
+
+#include "../quasi_errno.h"
+
+#include "../quasifs_mapping.h"
+
+namespace QuasiFS
+{
+
+    // holes are mapped to this
+    static const char zero_page[RegularFile::PAGE_SIZE]{};
+
+    FileMapping::~FileMapping()
+    {
+        Unmap();
+    }
+
+    FileMapping::FileMapping(FileMapping &&other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    FileMapping &FileMapping::operator=(FileMapping &&other) noexcept
+    {
+        if (this == &other)
+            return *this;
+
+        Unmap();
+
+        this->file = std::move(other.file);
+        this->pins = std::move(other.pins);
+        this->offset = other.offset;
+        this->length = other.length;
+        this->writable = other.writable;
+
+        // moved-from mapping must not release writable pin again
+        other.pins.clear();
+        other.length = 0;
+        other.writable = false;
+
+        return *this;
+    }
+
+    int FileMapping::Map(const file_ptr &file, quasi_off_t offset, quasi_size_t length, bool writable)
+    {
+        if (nullptr == file || offset < 0 || 0 == length)
+            return -QUASI_EINVAL;
+
+        if (offset + length > static_cast<quasi_size_t>(file->st.st_size))
+            return -QUASI_ENXIO;
+
+        Unmap();
+
+        // only pages can be pinned, a hole would stay one after writes to inline data
+        file->SpillInline(true);
+        file->idle_sweeps = 0;
+
+        quasi_size_t first_page = offset / RegularFile::PAGE_SIZE;
+        quasi_size_t last_page = (offset + length - 1) / RegularFile::PAGE_SIZE;
+
+        for (quasi_size_t page_idx = first_page; page_idx <= last_page; page_idx++)
+        {
+            if (writable)
+            {
+                // MockWrite may have left page table short
+                if (page_idx >= file->pages.size())
+                    file->pages.resize(page_idx + 1);
+                file->WritablePage(page_idx);
+            }
+            else
+                // compressed page must be back in the page table to be pinned
+                file->ReadablePage(page_idx);
+
+            this->pins.push_back(file->IsHole(page_idx) ? nullptr : file->pages[page_idx]);
+        }
+
+        this->file = file;
+        this->offset = offset;
+        this->length = length;
+        this->writable = writable;
+
+        if (writable)
+            file->writable_maps++;
+
+        return 0;
+    }
+
+    void FileMapping::Unmap(void)
+    {
+        if (file_ptr locked = this->file.lock(); nullptr != locked && this->writable)
+            locked->writable_maps--;
+
+        this->file.reset();
+        this->pins.clear();
+        this->offset = 0;
+        this->length = 0;
+        this->writable = false;
+    }
+
+    bool FileMapping::IsValid(void) const
+    {
+        file_ptr locked = this->file.lock();
+        if (nullptr == locked)
+            return false;
+
+        for (size_t idx = 0; idx < this->pins.size(); idx++)
+            if (!IsPageValid(*locked, idx))
+                return false;
+
+        return true;
+    }
+
+    std::span<const char> FileMapping::Segment(size_t idx) const
+    {
+        if (idx >= this->pins.size())
+            return {};
+
+        file_ptr locked = this->file.lock();
+        if (nullptr == locked || !IsPageValid(*locked, idx))
+            return {};
+
+        quasi_size_t page_base = (this->offset / RegularFile::PAGE_SIZE + idx) * RegularFile::PAGE_SIZE;
+        quasi_size_t start = 0 == idx ? this->offset - page_base : 0;
+        quasi_size_t end = std::min(RegularFile::PAGE_SIZE, this->offset + this->length - page_base);
+
+        const char *data = nullptr == this->pins[idx] ? zero_page : this->pins[idx]->data;
+        return {data + start, end - start};
+    }
+
+    std::span<char> FileMapping::WritableSegment(size_t idx)
+    {
+        if (!this->writable)
+            return {};
+
+        // writable mappings have no holes, so this is never the zero page
+        std::span<const char> segment = Segment(idx);
+        return {const_cast<char *>(segment.data()), segment.size()};
+    }
+
+    bool FileMapping::IsPageValid(const RegularFile &file, size_t idx) const
+    {
+        // whole mapped range must still be within the file
+        if (this->offset + this->length > static_cast<quasi_size_t>(file.st.st_size))
+            return false;
+
+        quasi_size_t page_idx = this->offset / RegularFile::PAGE_SIZE + idx;
+        if (file.IsHole(page_idx))
+            return nullptr == this->pins[idx];
+
+        return file.pages[page_idx] == this->pins[idx];
+    }
+}
@@ -3,6 +3,8 @@
 #include "../quasi_errno.h"
 #include "../quasi_types.h"
 
+#include "../quasifs_dedup.h"
+#include "../quasifs_dentry_cache.h"
 #include "../quasifs_partition.h"
 #include "../quasifs_inode_directory.h"
 #include "../quasifs_inode_regularfile.h"
@@ -14,7 +16,7 @@ namespace QuasiFS
 {
     Partition::Partition(const fs::path &host_root, const int root_permissions) : block_id(next_block_id++), host_root(host_root.lexically_normal())
     {
-        this->root = Directory::Create();
+        this->root = NewInode<Directory>();
         // clear defaults, write
         chmod(this->root, root_permissions);
         IndexInode(this->root);
@@ -55,58 +57,138 @@ namespace QuasiFS
 
     inode_ptr Partition::GetInodeByFileno(fileno_t fileno)
     {
-        auto ret = inode_table.find(fileno);
-        return (inode_table.end() == ret) ? nullptr : ret->second;
+        if (fileno < 0 || static_cast<size_t>(fileno) >= this->inode_table.size())
+            return nullptr;
+        return this->inode_table[fileno];
+    }
+
+    int Partition::SetCompression(uint32_t idle_sweeps)
+    {
+        if (IsHostMounted())
+            return -QUASI_EOPNOTSUPP;
+
+        this->compress_idle_sweeps = idle_sweeps;
+        return 0;
+    }
+
+    quasi_size_t Partition::SweepIdle(void)
+    {
+        if (0 == this->compress_idle_sweeps)
+            return 0;
+
+        quasi_size_t packed_count = 0;
+        for (inode_ptr &node : this->inode_table)
+            if (nullptr != node && node->is_file())
+                packed_count += std::static_pointer_cast<RegularFile>(node)->sweep(this->compress_idle_sweeps, this->compression_stats);
+
+        return packed_count;
+    }
+
+    int Partition::SetDedupStore(dedup_store_ptr store)
+    {
+        if (IsHostMounted())
+            return -QUASI_EOPNOTSUPP;
+
+        this->dedup_store = store;
+        return 0;
+    }
+
+    quasi_size_t Partition::Deduplicate(const file_ptr &file)
+    {
+        if (nullptr == this->dedup_store || nullptr == file)
+            return 0;
+
+        return file->dedup(*this->dedup_store);
+    }
+
+    quasi_size_t Partition::Deduplicate(void)
+    {
+        if (nullptr == this->dedup_store)
+            return 0;
+
+        quasi_size_t shared_count = 0;
+        for (inode_ptr &node : this->inode_table)
+            if (nullptr != node && node->is_file())
+                shared_count += std::static_pointer_cast<RegularFile>(node)->dedup(*this->dedup_store);
+
+        return shared_count;
     }
 
     int Partition::Resolve(fs::path &path, Resolved &res)
+    {
+        std::string_view path_view = path.native();
+        std::string_view local_path{};
+
+        int status = Resolve(path_view, res, local_path);
+        res.local_path = local_path;
+
+        // path was consumed up to a mountpoint or a symlink, leave only the remainder
+        if (path_view.data() != path.native().data() || path_view.size() != path.native().size())
+            path = fs::path(path_view);
+
+        return status;
+    }
+
+    int Partition::Resolve(std::string_view &path, Resolved &res)
+    {
+        std::string_view local_path{};
+
+        int status = Resolve(path, res, local_path);
+        res.local_path = local_path;
+
+        return status;
+    }
+
+    int Partition::Resolve(std::string_view &path, Resolved &res, std::string_view &local_path, dir_ptr start)
     {
         if (path.empty())
             return -QUASI_EINVAL;
 
-        if (path.is_relative())
+        // relative paths are walked from [start], local path is then relative to it as well
+        const bool relative = nullptr != start;
+
+        if (!relative && '/' != path.front())
             return -QUASI_EBADF;
 
         res.mountpoint = shared_from_this();
-        res.local_path = "/";
-        res.parent = this->root;
-        res.node = this->root;
-        res.leaf = "";
+        res.parent = relative ? start : this->root;
+        res.node = res.parent;
+        res.leaf = relative ? "." : "/";
+        local_path = path.substr(0, relative ? 0 : 1);
 
         // these hold up between iterations, but setting them can be ignored if the function is about to return
         dir_ptr parent = res.parent;
         inode_ptr current = res.node;
 
-        bool is_final = false;
+        // components are sliced from the path in-place, nothing is copied until the walk is over
+        // cursor always points right after the last consumed component
+        size_t cursor = relative ? 0 : 1;
+        const size_t walk_start = cursor;
 
-        for (auto part = path.begin(); part != path.end(); part++)
+        while (true)
         {
-            is_final = std::next(part) == path.end();
+            size_t part_start = path.find_first_not_of('/', cursor);
 
-            if ("/" == *part)
+            if (std::string_view::npos == part_start)
             {
-                res.local_path = "/";
-                res.parent = res.parent;
-                res.node = res.node;
-                res.leaf = "/";
-                continue;
-            }
-
-            // empty means trailing / which is interpreted only when using dirs or symlinks
-            if (part->empty())
-            {
-                if (!is_final)
-                    // something went wrong
-                    throw 666;
-
-                if (!(current->is_link() || current->is_dir()))
+                // trailing / is interpreted only when using dirs or symlinks
+                if (cursor < path.size() && walk_start != cursor && !(current->is_link() || current->is_dir()))
                     // trailing slash after a file
                     return -QUASI_ENOTDIR;
 
                 return 0;
             }
 
-            if (!(current->is_link() || current->is_dir()) && !is_final)
+            size_t part_end = path.find('/', part_start);
+            if (std::string_view::npos == part_end)
+                part_end = path.size();
+
+            const std::string_view part = path.substr(part_start, part_end - part_start);
+            // anything after this element (including trailing slash) makes it non-final
+            const bool is_final = part_end == path.size();
+            cursor = part_end;
+
+            if (!(current->is_link() || current->is_dir()))
             {
                 // path elements must be a dir or a symlink
                 return -QUASI_ENOTDIR;
@@ -121,12 +203,12 @@ namespace QuasiFS
 
                 dir_ptr dir = std::static_pointer_cast<Directory>(current);
                 parent = dir;
-                current = dir->lookup(*part);
+                current = dir->lookup(part);
 
-                res.local_path /= *part;
+                local_path = path.substr(0, part_end);
                 res.parent = parent;
                 res.node = current;
-                res.leaf = *part;
+                res.leaf = part;
             }
 
             // file not found in current directory, ENOENT
@@ -164,16 +246,12 @@ namespace QuasiFS
                 {
                     // if it's a mountpoint, the preceeding path is invalid from target partition's POV
                     // we take remainder of the path (current leaf name belongs to upstream) and leave everything
-                    // AFTER host's path
+                    // AFTER host's path, starting with separator
                     // since QFS holds mountpoint meta, its it's job to resolve mounted root directory.
-                    fs::path remainder = "/";
-                    for (auto p = std::next(part); p != path.end(); p++)
-                        remainder /= *p;
-                    path = remainder;
+                    path = is_final ? std::string_view("/") : path.substr(part_end);
 
                     res.parent = current_dir; // no point, unused in this context
                     res.node = current_dir->mounted_root;
-                    res.leaf = *part;
 
                     return 0;
                 }
@@ -184,14 +262,13 @@ namespace QuasiFS
             if (current->is_link())
             {
                 // just like with mountpoints, we discard everything up until the "next" element in path
-                fs::path remainder = "";
-                for (auto p = std::next(part); p != path.end(); p++)
-                    remainder /= *p;
-                path = remainder;
+                // symlink target is absolute, so remainder must be relative
+                size_t remainder_start = path.find_first_not_of('/', part_end);
+                path = std::string_view::npos == remainder_start ? std::string_view() : path.substr(remainder_start);
 
                 res.parent = parent;
                 res.node = current;
-                res.leaf = *part;
+
                 return 0;
             }
         }
@@ -212,7 +289,7 @@ namespace QuasiFS
 
     int Partition::mkdir(dir_ptr parent, const std::string &name)
     {
-        return mkdir(parent, name, Directory::Create());
+        return mkdir(parent, name, NewInode<Directory>());
     }
 
     int Partition::mkdir(dir_ptr parent, const std::string &name, dir_ptr child)
@@ -303,6 +380,8 @@ namespace QuasiFS
         if (nullptr == target)
             return -QUASI_EINVAL;
 
+        // permissions are checked on path resolution
+        DentryCache::Invalidate();
         return target->chmod(mode);
     }
 
@@ -326,10 +405,27 @@ namespace QuasiFS
 
         // TODO: check for open file handles, return -QUASI_EEBUSY
 
-        this->inode_table.erase(node->GetFileno());
+        fileno_t fileno = node->GetFileno();
+        if (fileno < 0 || static_cast<size_t>(fileno) >= this->inode_table.size() || node != this->inode_table[fileno])
+            return 0;
+
+        // number is released by the inode itself, once it's gone
+        this->inode_table[fileno] = nullptr;
         return 0;
     }
 
+    fileno_t Partition::NextFileno(void)
+    {
+        if (!this->free_filenos.empty())
+        {
+            fileno_t fileno = this->free_filenos.back();
+            this->free_filenos.pop_back();
+            return fileno;
+        }
+
+        return this->next_fileno++;
+    }
+
     bool Partition::IndexInode(inode_ptr node)
     {
         if (nullptr == node)
@@ -338,9 +434,15 @@ namespace QuasiFS
         // Assign fileno and add it to the fs table
         fileno_t node_fileno = node->GetFileno();
         if (node_fileno == -1)
+        {
             node_fileno = node->SetFileno(this->NextFileno());
+            // empty while constructing (root), root goes away with partition anyway
+            node->owner = weak_from_this();
+        }
 
-        inode_table[node_fileno] = node;
+        if (static_cast<size_t>(node_fileno) >= this->inode_table.size())
+            this->inode_table.resize(node_fileno + 1);
+        this->inode_table[node_fileno] = node;
         if (node->is_dir())
         {
             auto dir = std::static_pointer_cast<Directory>(node);
@@ -358,7 +460,6 @@ namespace QuasiFS
 
     void Partition::mkrelative(dir_ptr parent, dir_ptr child)
     {
-        child->link(".", child);
-        child->link("..", parent);
+        Directory::link_relatives(child, parent);
     }
 };
\ No newline at end of file
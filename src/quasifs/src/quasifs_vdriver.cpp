@@ -18,16 +18,24 @@ namespace QuasiFS
 {
 
     int QFS::OperationImpl::Open(const fs::path &path, int flags, quasi_mode_t mode)
+    {
+        return OpenAt(QUASI_AT_FDCWD, path, flags, mode);
+    }
+
+    int QFS::OperationImpl::OpenAt(const int dirfd, const fs::path &path, int flags, quasi_mode_t mode)
     {
         Resolved res;
         // Resolve for parent dir to avoid treating ENOENT as missing just the end file
-        int resolve_status = qfs.Resolve(path, res);
+        int resolve_status = qfs.ResolveAt(dirfd, path, res);
 
         // enoent on last element in the path is good
         if (-QUASI_ENOENT == resolve_status)
         {
             if (nullptr == res.parent)
                 return -QUASI_ENOENT;
+            // nothing to create, don't bother host
+            if (!(flags & QUASI_O_CREAT))
+                return -QUASI_ENOENT;
         }
         else if (0 != resolve_status)
             return resolve_status;
@@ -84,17 +92,19 @@ namespace QuasiFS
         if (vio_status < 0)
             return vio_status;
 
-        fd_handle_ptr handle = File::Create();
+        auto next_free_handle = qfs.GetFreeHandleNo();
+        // filled in place, slot is free (closed) until node is set
+        File &handle = qfs.open_fd[next_free_handle];
         // nasty hack, but: of it existed, no change
         // if it didn't, VIO will update this member
-        handle->node = res.node;
-        // virtual fd is stored in open_fd map
-        handle->host_fd = host_used ? hio_status : -1;
-        handle->read = request_read;
-        handle->write = request_write;
-        handle->append = request_append;
-        auto next_free_handle = qfs.GetFreeHandleNo();
-        qfs.open_fd[next_free_handle] = handle;
+        handle.node = res.node;
+        handle.mountpoint = res.mountpoint;
+        handle.local_path = res.local_path;
+        // virtual fd is stored in open_fd table
+        handle.host_fd = host_used ? hio_status : -1;
+        handle.read = request_read;
+        handle.write = request_write;
+        handle.append = request_append;
         return next_free_handle;
     }
 
@@ -110,22 +120,18 @@ namespace QuasiFS
             return -QUASI_EBADF;
 
         // if it fails, it fails
-        if (int hio_status = qfs.hio_driver.Close(handle->host_fd); hio_status < 0)
-            return hio_status;
+        if (handle->IsHostBound())
+            if (int hio_status = qfs.hio_driver.Close(handle->host_fd); hio_status < 0)
+                return hio_status;
 
         // no further action is required, this is pro-forma
         qfs.vio_driver.Close(fd);
 
-        // if it's the last entry, remove it to avoid blowing up fd table
-        // not really helping with fragmentation, but may save resources on burst opens
-
-        if (fd < (qfs.open_fd.size() - 1))
-        {
-            qfs.open_fd.at(fd) = nullptr;
-            return 0;
-        }
+        // contents are settled for now, share them if partition wants to
+        if (handle->write && !handle->IsHostBound() && handle->node->is_file() && nullptr != handle->mountpoint)
+            handle->mountpoint->Deduplicate(std::static_pointer_cast<RegularFile>(handle->node));
 
-        qfs.open_fd.pop_back();
+        qfs.ReleaseHandleNo(fd);
         return 0;
     }
 
@@ -193,11 +199,16 @@ namespace QuasiFS
     }
 
     int QFS::OperationImpl::Link(const fs::path &src, const fs::path &dst)
+    {
+        return LinkAt(QUASI_AT_FDCWD, src, QUASI_AT_FDCWD, dst);
+    }
+
+    int QFS::OperationImpl::LinkAt(const int src_dirfd, const fs::path &src, const int dst_dirfd, const fs::path &dst)
     {
         Resolved src_res;
         Resolved dst_res;
-        int status_what = qfs.Resolve(src, src_res);
-        int status_where = qfs.Resolve(dst, dst_res);
+        int status_what = qfs.ResolveAt(src_dirfd, src, src_res);
+        int status_where = qfs.ResolveAt(dst_dirfd, dst, dst_res);
 
         if (0 != status_what)
             return status_what;
@@ -250,17 +261,23 @@ namespace QuasiFS
     }
 
     int QFS::OperationImpl::Unlink(const fs::path &path)
+    {
+        return UnlinkAt(QUASI_AT_FDCWD, path);
+    }
+
+    int QFS::OperationImpl::UnlinkAt(const int dirfd, const fs::path &path)
     {
         Resolved res;
         int resolve_status;
 
         // symlinks mess this whole thing up, so we need toqfs.Resolve parent and leaf independently
 
-        fs::path parent_path = path.parent_path();
+        // bare name is relative to dirfd itself
+        fs::path parent_path = path.has_parent_path() ? path.parent_path() : ".";
         fs::path leaf = path.filename();
 
         // parent, must pass
-        resolve_status = qfs.Resolve(parent_path, res);
+        resolve_status = qfs.ResolveAt(dirfd, parent_path, res);
         if (resolve_status != 0)
             return resolve_status;
 
@@ -272,7 +289,7 @@ namespace QuasiFS
             return -QUASI_EROFS;
 
         dir_ptr parent = std::static_pointer_cast<Directory>(res.node);
-        inode_ptr target = parent->lookup(leaf);
+        inode_ptr target = parent->lookup(leaf.native());
 
         if (nullptr == target)
             return -QUASI_ENOENT;
@@ -444,6 +461,34 @@ namespace QuasiFS
         return vio_status;
     }
 
+    int QFS::OperationImpl::Clone(const int src_fd, const int dst_fd)
+    {
+        fd_handle_ptr src_handle = qfs.GetHandle(src_fd);
+        fd_handle_ptr dst_handle = qfs.GetHandle(dst_fd);
+        if (nullptr == src_handle || nullptr == dst_handle)
+            return -QUASI_EBADF;
+
+        if (!src_handle->read || !dst_handle->write || dst_handle->append)
+            return -QUASI_EBADF;
+
+        inode_ptr src_node = src_handle->node;
+        inode_ptr dst_node = dst_handle->node;
+
+        if (src_node->is_dir() || dst_node->is_dir())
+            return -QUASI_EISDIR;
+        if (!src_node->is_file() || !dst_node->is_file())
+            return -QUASI_EINVAL;
+
+        if (src_handle->mountpoint != dst_handle->mountpoint)
+            return -QUASI_EXDEV;
+
+        // host-bound files don't keep their data here
+        if (src_handle->IsHostBound() || dst_handle->IsHostBound())
+            return -QUASI_EOPNOTSUPP;
+
+        return std::static_pointer_cast<RegularFile>(dst_node)->clone(*std::static_pointer_cast<RegularFile>(src_node));
+    }
+
     quasi_off_t QFS::OperationImpl::LSeek(const int fd, quasi_off_t offset, SeekOrigin origin)
     {
         fd_handle_ptr handle = qfs.GetHandle(fd);
@@ -451,8 +496,8 @@ namespace QuasiFS
             return -QUASI_EBADF;
 
         bool host_used = false;
-        int hio_status = 0;
-        int vio_status = 0;
+        quasi_off_t hio_status = 0;
+        quasi_off_t vio_status = 0;
 
         if (handle->IsHostBound())
         {
@@ -461,6 +506,13 @@ namespace QuasiFS
                 // hosts operation must succeed in order to continue
                 return hio_status;
             host_used = true;
+
+            // only host knows where its holes are
+            if (SeekOrigin::DATA == origin || SeekOrigin::HOLE == origin)
+            {
+                offset = hio_status;
+                origin = SeekOrigin::ORIGIN;
+            }
         }
 
         qfs.vio_driver.SetCtx(nullptr, host_used, handle);
@@ -498,8 +550,8 @@ namespace QuasiFS
             return -QUASI_EBADF;
 
         bool host_used = false;
-        int hio_status = 0;
-        int vio_status = 0;
+        quasi_ssize_t hio_status = 0;
+        quasi_ssize_t vio_status = 0;
 
         if (handle->IsHostBound())
         {
@@ -530,8 +582,8 @@ namespace QuasiFS
             return -QUASI_EBADF;
 
         bool host_used = false;
-        int hio_status = 0;
-        int vio_status = 0;
+        quasi_ssize_t hio_status = 0;
+        quasi_ssize_t vio_status = 0;
 
         if (handle->IsHostBound())
         {
@@ -562,8 +614,8 @@ namespace QuasiFS
             return -QUASI_EBADF;
 
         bool host_used = false;
-        int hio_status = 0;
-        int vio_status = 0;
+        quasi_ssize_t hio_status = 0;
+        quasi_ssize_t vio_status = 0;
 
         if (handle->IsHostBound())
         {
@@ -594,8 +646,8 @@ namespace QuasiFS
             return -QUASI_EBADF;
 
         bool host_used = false;
-        int hio_status = 0;
-        int vio_status = 0;
+        quasi_ssize_t hio_status = 0;
+        quasi_ssize_t vio_status = 0;
 
         if (handle->IsHostBound())
         {
@@ -616,10 +668,177 @@ namespace QuasiFS
         return vio_status;
     };
 
+    quasi_ssize_t QFS::OperationImpl::WriteV(const int fd, const quasi_iovec_t *iov, int iovcnt)
+    {
+        fd_handle_ptr handle = qfs.GetHandle(fd);
+        if (nullptr == handle)
+            return -QUASI_EBADF;
+
+        if (!handle->write)
+            return -QUASI_EBADF;
+
+        if (iovcnt < 0 || iovcnt > QUASI_IOV_MAX)
+            return -QUASI_EINVAL;
+
+        bool host_used = false;
+        quasi_ssize_t hio_status = 0;
+        quasi_ssize_t vio_status = 0;
+
+        if (handle->IsHostBound())
+        {
+            int host_fd = handle->host_fd;
+            // single host syscall for all buffers
+            if (hio_status = qfs.hio_driver.WriteV(host_fd, iov, iovcnt); hio_status < 0)
+                // hosts operation must succeed in order to continue
+                return hio_status;
+            host_used = true;
+        }
+
+        qfs.vio_driver.SetCtx(nullptr, host_used, handle);
+        vio_status = qfs.vio_driver.WriteV(fd, iov, iovcnt);
+        qfs.vio_driver.ClearCtx();
+
+        if (host_used && (hio_status != vio_status))
+            LogError("Host returned {}, but virtual driver returned {}", hio_status, vio_status);
+
+        return vio_status;
+    }
+
+    quasi_ssize_t QFS::OperationImpl::PWriteV(const int fd, const quasi_iovec_t *iov, int iovcnt, quasi_off_t offset)
+    {
+        fd_handle_ptr handle = qfs.GetHandle(fd);
+        if (nullptr == handle)
+            return -QUASI_EBADF;
+
+        if (!handle->write)
+            return -QUASI_EBADF;
+
+        if (iovcnt < 0 || iovcnt > QUASI_IOV_MAX)
+            return -QUASI_EINVAL;
+
+        bool host_used = false;
+        quasi_ssize_t hio_status = 0;
+        quasi_ssize_t vio_status = 0;
+
+        if (handle->IsHostBound())
+        {
+            int host_fd = handle->host_fd;
+            // single host syscall for all buffers
+            if (hio_status = qfs.hio_driver.PWriteV(host_fd, iov, iovcnt, offset); hio_status < 0)
+                // hosts operation must succeed in order to continue
+                return hio_status;
+            host_used = true;
+        }
+
+        qfs.vio_driver.SetCtx(nullptr, host_used, handle);
+        vio_status = qfs.vio_driver.PWriteV(fd, iov, iovcnt, offset);
+        qfs.vio_driver.ClearCtx();
+
+        if (host_used && (hio_status != vio_status))
+            LogError("Host returned {}, but virtual driver returned {}", hio_status, vio_status);
+
+        return vio_status;
+    }
+
+    quasi_ssize_t QFS::OperationImpl::ReadV(const int fd, const quasi_iovec_t *iov, int iovcnt)
+    {
+        fd_handle_ptr handle = qfs.GetHandle(fd);
+        if (nullptr == handle)
+            return -QUASI_EBADF;
+
+        if (!handle->read)
+            return -QUASI_EBADF;
+
+        if (iovcnt < 0 || iovcnt > QUASI_IOV_MAX)
+            return -QUASI_EINVAL;
+
+        bool host_used = false;
+        quasi_ssize_t hio_status = 0;
+        quasi_ssize_t vio_status = 0;
+
+        if (handle->IsHostBound())
+        {
+            int host_fd = handle->host_fd;
+            // single host syscall for all buffers
+            if (hio_status = qfs.hio_driver.ReadV(host_fd, iov, iovcnt); hio_status < 0)
+                // hosts operation must succeed in order to continue
+                return hio_status;
+            host_used = true;
+        }
+
+        qfs.vio_driver.SetCtx(nullptr, host_used, handle);
+        vio_status = qfs.vio_driver.ReadV(fd, iov, iovcnt);
+        qfs.vio_driver.ClearCtx();
+
+        if (host_used && (hio_status != vio_status))
+            LogError("Host returned {}, but virtual driver returned {}", hio_status, vio_status);
+
+        return vio_status;
+    }
+
+    quasi_ssize_t QFS::OperationImpl::PReadV(const int fd, const quasi_iovec_t *iov, int iovcnt, quasi_off_t offset)
+    {
+        fd_handle_ptr handle = qfs.GetHandle(fd);
+        if (nullptr == handle)
+            return -QUASI_EBADF;
+
+        if (!handle->read)
+            return -QUASI_EBADF;
+
+        if (iovcnt < 0 || iovcnt > QUASI_IOV_MAX)
+            return -QUASI_EINVAL;
+
+        bool host_used = false;
+        quasi_ssize_t hio_status = 0;
+        quasi_ssize_t vio_status = 0;
+
+        if (handle->IsHostBound())
+        {
+            int host_fd = handle->host_fd;
+            // single host syscall for all buffers
+            if (hio_status = qfs.hio_driver.PReadV(host_fd, iov, iovcnt, offset); hio_status < 0)
+                // hosts operation must succeed in order to continue
+                return hio_status;
+            host_used = true;
+        }
+
+        qfs.vio_driver.SetCtx(nullptr, host_used, handle);
+        vio_status = qfs.vio_driver.PReadV(fd, iov, iovcnt, offset);
+        qfs.vio_driver.ClearCtx();
+
+        if (host_used && (hio_status != vio_status))
+            LogError("Host returned {}, but virtual driver returned {}", hio_status, vio_status);
+
+        return vio_status;
+    }
+
+    quasi_ssize_t QFS::OperationImpl::GetDents(const int fd, void *buf, quasi_size_t nbytes)
+    {
+        fd_handle_ptr handle = qfs.GetHandle(fd);
+        if (nullptr == handle)
+            return -QUASI_EBADF;
+
+        if (!handle->read)
+            return -QUASI_EBADF;
+
+        // always listed from QFS tree, host-bound directories are kept in sync with host anyway
+        // and host's dirent layout is platform-specific
+        qfs.vio_driver.SetCtx(nullptr, handle->IsHostBound(), handle);
+        quasi_ssize_t vio_status = qfs.vio_driver.GetDents(fd, buf, nbytes);
+        qfs.vio_driver.ClearCtx();
+
+        return vio_status;
+    }
+
     int QFS::OperationImpl::MKDir(const fs::path &path, quasi_mode_t mode)
+    {
+        return MKDirAt(QUASI_AT_FDCWD, path, mode);
+    }
+
+    int QFS::OperationImpl::MKDirAt(const int dirfd, const fs::path &path, quasi_mode_t mode)
     {
         Resolved res;
-        int resolve_status = qfs.Resolve(path, res);
+        int resolve_status = qfs.ResolveAt(dirfd, path, res);
 
         if (0 == resolve_status)
             return -QUASI_EEXIST;
@@ -699,9 +918,14 @@ namespace QuasiFS
     }
 
     int QFS::OperationImpl::Stat(const fs::path &path, quasi_stat_t *statbuf)
+    {
+        return StatAt(QUASI_AT_FDCWD, path, statbuf);
+    }
+
+    int QFS::OperationImpl::StatAt(const int dirfd, const fs::path &path, quasi_stat_t *statbuf)
     {
         Resolved res;
-        int resolve_status = qfs.Resolve(path, res);
+        int resolve_status = qfs.ResolveAt(dirfd, path, res);
 
         if (nullptr == res.node || resolve_status < 0)
         {
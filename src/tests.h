@@ -2,28 +2,65 @@
 
 #pragma once
 
+#include <algorithm>
 #include <iostream>
 #include <fstream>
+#include <map>
 
+#include "quasifs/quasifs_dedup.h"
 #include "quasifs/quasifs_inode_directory.h"
 #include "quasifs/quasifs_inode_regularfile.h"
 #include "quasifs/quasifs_inode_symlink.h"
+#include "quasifs/quasifs_lz.h"
 #include "quasifs/quasifs_partition.h"
 #include "quasifs/quasifs.h"
 
 #include "quasifs/quasi_sys_fcntl.h"
+#include "quasifs/quasi_sys_mman.h"
 
 #include "../../dev/include/dev_std.h"
 #include "log.h"
 
 using namespace QuasiFS;
 
+// Virtual partition mounted at [path] until end of scope
+// Storage under test is virtual, host-bound files only mock it
+struct VirtualMount
+{
+    VirtualMount(QFS &qfs, const fs::path &path) : qfs(qfs), path(path)
+    {
+        qfs.Operation.MKDir(path);
+        qfs.Mount(path, part, MountOptions::MOUNT_RW);
+    }
+
+    ~VirtualMount()
+    {
+        qfs.Unmount(path);
+        qfs.Operation.RMDir(path);
+    }
+
+    VirtualMount(const VirtualMount &) = delete;
+    VirtualMount &operator=(const VirtualMount &) = delete;
+
+    QFS &qfs;
+    const fs::path path;
+    const partition_ptr part = Partition::Create();
+};
+
 // Path resolution
 void TestResolve(QFS &qfs);
+void TestDentryCache(QFS &qfs);
+void TestNegativeDentryCache(QFS &qfs);
+void TestResolveAt(QFS &qfs);
+void TestResolveMany(QFS &qfs);
 
 // Inode manip
 void TestTouchUnlinkFile(QFS &qfs);
 void TestMkRmdir(QFS &qfs);
+void TestLargeDirectory(QFS &qfs);
+void TestInodeNumbers(QFS &qfs);
+void TestInodePool(QFS &qfs);
+void TestDirectoryLifetime(QFS &qfs);
 
 // Mounts (partitions)
 void TestMount(QFS &qfs);
@@ -45,6 +82,7 @@ void TestSync(QFS &qfs)
     file.open("sync/1.txt");
     file.close();
     file.open("sync/a/1.txt");
+    file << "sync";
     file.close();
 
     auto part = Partition::Create("sync");
@@ -52,6 +90,25 @@ void TestSync(QFS &qfs)
     qfs.Operation.MKDir("/sync");
     qfs.Mount("/sync", part, MountOptions::MOUNT_NOOPT);
     qfs.SyncHost("/sync");
+
+    // /sync/a holds 1.txt and b; Stat() would overlay host values, check inodes themselves
+    Resolved res;
+    qfs.Resolve("/sync/a", res);
+    quasi_stat_t st = res.node->st;
+    quasi_size_t dirents = 0;
+    for (const char *name : {".", "..", "1.txt", "b"})
+        dirents += Directory::dirent_size(strlen(name));
+    if (QUASI_S_ISDIR(st.st_mode) && 3 == st.st_nlink && static_cast<quasi_size_t>(st.st_size) == dirents)
+        LogSuccess("Synced directory keeps its own link count and size");
+    else
+        LogError("Synced directory: mode {:o}, {} links, size {}/{}", st.st_mode, st.st_nlink, st.st_size, dirents);
+
+    qfs.Resolve("/sync/a/1.txt", res);
+    st = res.node->st;
+    if (QUASI_S_ISREG(st.st_mode) && 4 == st.st_size)
+        LogSuccess("Synced file takes host size");
+    else
+        LogError("Synced file: mode {:o}, size {}", st.st_mode, st.st_size);
 }
 
 // Links
@@ -63,15 +120,29 @@ void TestStLinkMixed(QFS &qfs);
 void TestSymlinkFile(QFS &qfs);
 void TestSymlinkDir(QFS &qfs);
 void TestSymlinkCursed(QFS &qfs);
+void TestSymlinkTargetCache(QFS &qfs);
 
 // Files (I/O)
 void TestFileOpen(QFS &qfs);
 void TestFileOps(QFS &qfs);
 void TestFileSeek(QFS &qfs);
+void TestFileDescriptors(QFS &qfs);
 
 // Directories (I/O)
 void TestDirOpen(QFS &qfs);
 void TestDirOps(QFS &qfs);
+void TestDirGetDents(QFS &qfs);
+void TestDirStats(QFS &qfs);
+void TestFileBulkIO(QFS &qfs);
+void TestFilePages(QFS &qfs);
+void TestInlineFile(QFS &qfs);
+void TestCompression(QFS &qfs);
+void TestDedup(QFS &qfs);
+void TestSparseFile(QFS &qfs);
+void TestClone(QFS &qfs);
+void TestMap(QFS &qfs);
+void TestVectoredIO(QFS &qfs);
+void TestLargeFile(QFS &qfs);
 
 // Stat
 void TestStat(QFS &qfs)
@@ -147,10 +218,18 @@ void Test(QFS &qfs)
 
     // Path resolution
     TestResolve(qfs);
+    TestDentryCache(qfs);
+    TestNegativeDentryCache(qfs);
+    TestResolveAt(qfs);
+    TestResolveMany(qfs);
 
     // Inode manip
     TestTouchUnlinkFile(qfs);
     TestMkRmdir(qfs);
+    TestLargeDirectory(qfs);
+    TestInodeNumbers(qfs);
+    TestInodePool(qfs);
+    TestDirectoryLifetime(qfs);
 
     // Mounts (partitions)
     TestMount(qfs);
@@ -167,15 +246,29 @@ void Test(QFS &qfs)
     TestSymlinkFile(qfs);
     TestSymlinkDir(qfs);
     TestSymlinkCursed(qfs);
+    TestSymlinkTargetCache(qfs);
 
     // Files (I/O)
     TestFileOpen(qfs);
     TestFileOps(qfs);
     TestFileSeek(qfs);
+    TestFileDescriptors(qfs);
 
     // Directories (I/O)
     TestDirOpen(qfs);
     TestDirOps(qfs);
+    TestDirGetDents(qfs);
+    TestDirStats(qfs);
+    TestFileBulkIO(qfs);
+    TestFilePages(qfs);
+    TestInlineFile(qfs);
+    TestCompression(qfs);
+    TestDedup(qfs);
+    TestSparseFile(qfs);
+    TestClone(qfs);
+    TestMap(qfs);
+    TestVectoredIO(qfs);
+    TestLargeFile(qfs);
 
     // Stat
     TestStat(qfs);
@@ -195,6 +288,279 @@ void Test(QFS &qfs)
 
 void TestResolve(QFS &qfs) { UNIMPLEMENTED() }
 
+void TestDentryCache(QFS &qfs)
+{
+    LogTest("Dentry cache");
+
+    Resolved res;
+    Resolved res_cached;
+
+    qfs.Operation.MKDir("/cache");
+    qfs.Operation.MKDir("/cache/deep");
+    qfs.Operation.Close(qfs.Operation.Creat("/cache/deep/file"));
+
+    int status = qfs.Resolve("/cache/deep/file", res);
+    int status_cached = qfs.Resolve("/cache/deep/file", res_cached);
+
+    if (0 == status && 0 == status_cached && res.node == res_cached.node && res.parent == res_cached.parent &&
+        res.mountpoint == res_cached.mountpoint && res.local_path == res_cached.local_path && res.leaf == res_cached.leaf)
+        LogSuccess("Cached resolution is the same as the original one");
+    else
+        LogError("Cached resolution differs: {} vs {}", status, status_cached);
+
+    qfs.Operation.Unlink("/cache/deep/file");
+
+    if (int status = qfs.Resolve("/cache/deep/file", res); -QUASI_ENOENT == status)
+        LogSuccess("Unlink invalidated cached entry");
+    else
+        LogError("Stale entry returned after unlink: {}", status);
+
+    partition_ptr part = Partition::Create();
+    qfs.Resolve("/cache/deep", res_cached);
+    qfs.Mount("/cache/deep", part, MountOptions::MOUNT_RW);
+
+    if (int status = qfs.Resolve("/cache/deep", res); 0 == status && res.node == part->GetRoot() && res.mountpoint == part)
+        LogSuccess("Mount invalidated cached entry");
+    else
+        LogError("Stale entry returned after mount: {}", status);
+
+    qfs.Unmount("/cache/deep");
+
+    if (int status = qfs.Resolve("/cache/deep", res); 0 == status && res.node == res_cached.node)
+        LogSuccess("Unmount invalidated cached entry");
+    else
+        LogError("Stale entry returned after unmount: {}", status);
+
+    qfs.Operation.RMDir("/cache/deep");
+    qfs.Operation.RMDir("/cache");
+}
+
+void TestNegativeDentryCache(QFS &qfs)
+{
+    LogTest("Negative dentry cache");
+
+    Resolved res;
+
+    qfs.Operation.MKDir("/probe");
+    qfs.Operation.MKDir("/probe_target");
+    qfs.Operation.LinkSymbolic("/probe_target/override.cfg", "/probe/link.cfg");
+
+    for (int probe = 0; probe < 2; probe++)
+    {
+        if (int status = qfs.Resolve("/probe/override.cfg", res); -QUASI_ENOENT == status && nullptr != res.parent && "override.cfg" == res.leaf)
+            LogSuccess("Missing file probe {} returned ENOENT with parent set", probe);
+        else
+            LogError("Missing file probe {} returned {}", probe, status);
+
+        if (int fd = qfs.Operation.Open("/probe/override.cfg", QUASI_O_RDONLY); -QUASI_ENOENT == fd)
+            LogSuccess("Open on missing file probe {} returned ENOENT", probe);
+        else
+            LogError("Open on missing file probe {} returned {}", probe, fd);
+    }
+
+    qfs.Operation.Close(qfs.Operation.Creat("/probe/override.cfg"));
+
+    if (int status = qfs.Resolve("/probe/override.cfg", res); 0 == status && nullptr != res.node)
+        LogSuccess("Creating probed file invalidated negative entry");
+    else
+        LogError("Stale negative entry returned after creating the file: {}", status);
+
+    if (int status = qfs.Resolve("/probe/link.cfg", res); -QUASI_ENOENT == status)
+        LogSuccess("Dangling symlink probe returned ENOENT");
+    else
+        LogError("Dangling symlink probe returned {}", status);
+
+    qfs.Operation.Close(qfs.Operation.Creat("/probe_target/override.cfg"));
+
+    if (int status = qfs.Resolve("/probe/link.cfg", res); 0 == status && nullptr != res.node)
+        LogSuccess("Creating symlink target invalidated negative entry");
+    else
+        LogError("Stale negative entry returned after creating symlink target: {}", status);
+
+    qfs.Operation.Unlink("/probe/link.cfg");
+    qfs.Operation.Unlink("/probe/override.cfg");
+    qfs.Operation.Unlink("/probe_target/override.cfg");
+    qfs.Operation.RMDir("/probe");
+    qfs.Operation.RMDir("/probe_target");
+}
+
+void TestResolveAt(QFS &qfs)
+{
+    LogTest("Directory-relative operations");
+
+    Resolved res;
+    quasi_stat_t st_at;
+    quasi_stat_t st_abs;
+
+    qfs.Operation.MKDir("/at");
+    qfs.Operation.MKDir("/at/deep");
+    int dirfd = qfs.Operation.Open("/at/deep", QUASI_O_RDONLY | QUASI_O_DIRECTORY);
+
+    if (int status = qfs.Operation.MKDirAt(dirfd, "sub"); 0 == status && 0 == qfs.Resolve("/at/deep/sub", res) && res.node->is_dir())
+        LogSuccess("MKDirAt created directory");
+    else
+        LogError("MKDirAt returned {}", status);
+
+    if (int fd = qfs.Operation.OpenAt(dirfd, "sub/file", QUASI_O_CREAT | QUASI_O_WRONLY); fd >= 0)
+    {
+        LogSuccess("OpenAt created file");
+        qfs.Operation.Close(fd);
+    }
+    else
+        LogError("OpenAt returned {}", fd);
+
+    if (0 == qfs.Operation.StatAt(dirfd, "sub/file", &st_at) && 0 == qfs.Operation.Stat("/at/deep/sub/file", &st_abs) && st_at.st_ino == st_abs.st_ino)
+        LogSuccess("StatAt matches absolute Stat");
+    else
+        LogError("StatAt doesn't match absolute Stat");
+
+    if (0 == qfs.Operation.StatAt(dirfd, "..", &st_at) && 0 == qfs.Operation.Stat("/at", &st_abs) && st_at.st_ino == st_abs.st_ino)
+        LogSuccess("StatAt resolved parent directory");
+    else
+        LogError("StatAt didn't resolve parent directory");
+
+    if (int status = qfs.Operation.LinkAt(dirfd, "sub/file", dirfd, "hardlink"); 0 == status && 0 == qfs.Resolve("/at/deep/hardlink", res) && 2 == res.node->st.st_nlink)
+        LogSuccess("LinkAt created hardlink");
+    else
+        LogError("LinkAt returned {}", status);
+
+    if (int status = qfs.Operation.UnlinkAt(dirfd, "hardlink"); 0 == status && -QUASI_ENOENT == qfs.Resolve("/at/deep/hardlink", res))
+        LogSuccess("UnlinkAt removed bare name");
+    else
+        LogError("UnlinkAt on bare name returned {}", status);
+
+    if (int status = qfs.Operation.UnlinkAt(dirfd, "sub/file"); 0 == status && -QUASI_ENOENT == qfs.Resolve("/at/deep/sub/file", res))
+        LogSuccess("UnlinkAt removed nested name");
+    else
+        LogError("UnlinkAt on nested name returned {}", status);
+
+    if (int status = qfs.Operation.StatAt(QUASI_AT_FDCWD, "sub", &st_at); -QUASI_EBADF == status)
+        LogSuccess("Relative path without dirfd rejected");
+    else
+        LogError("Relative path without dirfd returned {}", status);
+
+    int filefd = qfs.Operation.Creat("/at/file");
+    if (int status = qfs.Operation.StatAt(filefd, "sub", &st_at); -QUASI_ENOTDIR == status)
+        LogSuccess("Non-directory dirfd rejected");
+    else
+        LogError("Non-directory dirfd returned {}", status);
+    qfs.Operation.Close(filefd);
+
+    // walk starting in mounted root, local path must be relative to mounted partition
+    partition_ptr part = Partition::Create();
+    qfs.Mount("/at/deep/sub", part, MountOptions::MOUNT_RW);
+    int mntfd = qfs.Operation.Open("/at/deep/sub", QUASI_O_RDONLY | QUASI_O_DIRECTORY);
+
+    if (int status = qfs.Operation.MKDirAt(mntfd, "inner"); 0 == status && 0 == qfs.Resolve("/at/deep/sub/inner", res) &&
+                                                             res.mountpoint == part && "/inner" == res.local_path)
+        LogSuccess("MKDirAt in mounted root");
+    else
+        LogError("MKDirAt in mounted root returned {}", status);
+
+    qfs.Operation.Close(mntfd);
+    qfs.Operation.Close(dirfd);
+
+    qfs.Operation.RMDir("/at/deep/sub/inner");
+    qfs.Unmount("/at/deep/sub");
+    qfs.Operation.RMDir("/at/deep/sub");
+    qfs.Operation.RMDir("/at/deep");
+    qfs.Operation.Unlink("/at/file");
+    qfs.Operation.RMDir("/at");
+}
+
+void TestResolveMany(QFS &qfs)
+{
+    LogTest("Batched resolution");
+
+    qfs.Operation.MKDir("/batch");
+    qfs.Operation.MKDir("/batch/a");
+    qfs.Operation.MKDir("/batch/a/b");
+    qfs.Operation.MKDir("/batch/mnt");
+    qfs.Operation.Close(qfs.Operation.Creat("/batch/a/b/file"));
+    qfs.Operation.LinkSymbolic("/batch/a", "/batch/link");
+    // every hop through it counts towards the loop limit, no matter how path is split
+    qfs.Operation.LinkSymbolic("/batch", "/batch/s");
+
+    std::string short_chain = "/batch";
+    std::string long_chain = "/batch";
+    for (int idx = 0; idx < 45; idx++)
+    {
+        long_chain += "/s";
+        if (idx < 10)
+            short_chain += "/s";
+    }
+
+    partition_ptr part = Partition::Create();
+    qfs.Mount("/batch/mnt", part, MountOptions::MOUNT_RW);
+    qfs.Operation.MKDir("/batch/mnt/inner");
+    qfs.Operation.Close(qfs.Operation.Creat("/batch/mnt/inner/file"));
+
+    const std::vector<fs::path> paths = {
+        "/batch/a/b/file",
+        "/batch/a/b",
+        "/batch/a/b/missing",
+        "/batch/a/missing/file",
+        "/batch/a/b/file/file",
+        "/batch/link/b/file",
+        "/batch/link/b/",
+        "/batch/link",
+        "/batch/mnt",
+        "/batch/mnt/inner/file",
+        "/batch/mnt/inner/../inner/file",
+        "/",
+        "relative/path",
+        short_chain + "/a/b/file",
+        long_chain + "/a/b/file",
+    };
+
+    std::vector<Resolved> res(paths.size());
+    std::vector<int> status(paths.size());
+
+    DentryCache::Invalidate();
+    int resolved = qfs.ResolveMany(paths, res, status);
+    int expected_resolved = 0;
+    bool all_good = true;
+
+    for (size_t idx = 0; idx < paths.size(); idx++)
+    {
+        Resolved single;
+        DentryCache::Invalidate();
+        int single_status = qfs.Resolve(paths[idx], single);
+        expected_resolved += 0 == single_status;
+
+        if (single_status == status[idx] && single.node == res[idx].node && single.parent == res[idx].parent &&
+            single.mountpoint == res[idx].mountpoint && single.local_path == res[idx].local_path && single.leaf == res[idx].leaf)
+            continue;
+
+        LogError("Batched resolution of {} differs from single one: {} vs {}", paths[idx].string(), status[idx], single_status);
+        all_good = false;
+    }
+
+    if (all_good)
+        LogSuccess("Batched resolution matches single resolutions");
+
+    if (resolved == expected_resolved)
+        LogSuccess("Batched resolution returned {} resolved paths", resolved);
+    else
+        LogError("Batched resolution returned {} resolved paths, expected {}", resolved, expected_resolved);
+
+    if (int status = qfs.ResolveMany(paths, std::span<Resolved>(res).first(1)); -QUASI_EINVAL == status)
+        LogSuccess("Too small output rejected");
+    else
+        LogError("Too small output returned {}", status);
+
+    qfs.Operation.Unlink("/batch/mnt/inner/file");
+    qfs.Operation.RMDir("/batch/mnt/inner");
+    qfs.Unmount("/batch/mnt");
+    qfs.Operation.RMDir("/batch/mnt");
+    qfs.Operation.Unlink("/batch/link");
+    qfs.Operation.Unlink("/batch/s");
+    qfs.Operation.Unlink("/batch/a/b/file");
+    qfs.Operation.RMDir("/batch/a/b");
+    qfs.Operation.RMDir("/batch/a");
+    qfs.Operation.RMDir("/batch");
+}
+
 //
 // Inode manip
 //
@@ -295,6 +661,83 @@ void TestMkRmdir(QFS &qfs)
         LogError("dir not removed: {}", status);
 }
 
+void TestLargeDirectory(QFS &qfs)
+{
+    LogTest("Directory with many entries");
+
+    const int entry_count = 20000;
+    Resolved res;
+
+    qfs.Operation.MKDir("/large");
+    qfs.Resolve("/large", res);
+    partition_ptr part = res.mountpoint;
+    dir_ptr dir = std::static_pointer_cast<Directory>(res.node);
+
+    for (int idx = 0; idx < entry_count; idx++)
+        part->touch(dir, "slot_" + std::to_string(idx), RegularFile::Create());
+
+    // . and .. aren't stored
+    if (entry_count == dir->entries.size())
+        LogSuccess("All entries added");
+    else
+        LogError("Entry count mismatch: {}/{}", dir->entries.size(), entry_count);
+
+    // drop every other entry, leaves tombstones in between
+    for (int idx = 0; idx < entry_count; idx += 2)
+        dir->unlink("slot_" + std::to_string(idx));
+
+    int found = 0;
+    int stale = 0;
+    for (int idx = 0; idx < entry_count; idx++)
+    {
+        bool exists = nullptr != dir->lookup("slot_" + std::to_string(idx));
+        found += exists;
+        stale += exists == (0 == idx % 2);
+    }
+
+    if (entry_count / 2 == found && 0 == stale && entry_count / 2 == dir->entries.size())
+        LogSuccess("Lookups after removal are correct");
+    else
+        LogError("Lookups after removal: {} found, {} wrong", found, stale);
+
+    size_t iterated = 0;
+    for (auto &[name, node] : dir->entries)
+        iterated += nullptr != node;
+
+    if (dir->entries.size() == iterated)
+        LogSuccess("Iteration skips removed entries");
+    else
+        LogError("Iterated over {}/{} entries", iterated, dir->entries.size());
+
+    if (-QUASI_EEXIST == part->touch(dir, "slot_1", RegularFile::Create()) && 0 == part->touch(dir, "slot_0", RegularFile::Create()))
+        LogSuccess("Existing name rejected, removed name reused");
+    else
+        LogError("Re-adding names failed");
+
+    // slot_0 went back to position 0, slot_99 is the last one left
+    const int kept = 100;
+    for (int idx = kept; idx < entry_count; idx++)
+        dir->unlink("slot_" + std::to_string(idx));
+
+    if (static_cast<size_t>(kept) == dir->entries.positions() && dir->entries.capacity() <= 4 * dir->entries.size())
+        LogSuccess("Table shrinks after removal");
+    else
+        LogError("Table not shrunk: {} positions, {} slots for {} entries", dir->entries.positions(), dir->entries.capacity(), dir->entries.size());
+
+    for (int idx = 0; idx < kept; idx++)
+        dir->unlink("slot_" + std::to_string(idx));
+
+    if (0 == dir->entries.positions() && 0 == dir->entries.capacity())
+        LogSuccess("Empty table released");
+    else
+        LogError("Empty table keeps {} positions, {} slots", dir->entries.positions(), dir->entries.capacity());
+
+    if (int status = qfs.Operation.RMDir("/large"); 0 == status)
+        LogSuccess("Emptied directory removed");
+    else
+        LogError("Can't remove emptied directory: {}", status);
+}
+
 //
 // Mounts (partitions)
 //
@@ -912,6 +1355,111 @@ void TestSymlinkCursed(QFS &qfs)
         LogError("Unlinking a symlink removed the file it pointed to: {}", resolve_status);
 }
 
+void TestSymlinkTargetCache(QFS &qfs)
+{
+    LogTest("Cached symlink targets");
+
+    Resolved res;
+    Resolved res_cached;
+
+    qfs.Operation.MKDir("/stc");
+    qfs.Operation.MKDir("/stc/dir");
+    qfs.Operation.MKDir("/stc/mnt");
+    qfs.Operation.Close(qfs.Operation.Creat("/stc/dir/file"));
+    qfs.Operation.LinkSymbolic("/stc/dir/file", "/stc/filelink");
+    qfs.Operation.LinkSymbolic("/stc/dir", "/stc/dirlink");
+    qfs.Operation.LinkSymbolic("/stc/mnt", "/stc/mntlink");
+
+    partition_ptr part = Partition::Create();
+    qfs.Mount("/stc/mnt", part, MountOptions::MOUNT_RW);
+    qfs.Operation.Close(qfs.Operation.Creat("/stc/mnt/file"));
+
+    // different spelling of the same path misses dentry cache, but goes through symlink's target cache
+    int status = qfs.Resolve("/stc/filelink", res);
+    int status_cached = qfs.Resolve("/stc/./filelink", res_cached);
+
+    if (0 == status && 0 == status_cached && res.node == res_cached.node && res.parent == res_cached.parent &&
+        res.local_path == res_cached.local_path && res.leaf == res_cached.leaf && "/stc/dir/file" == res_cached.local_path)
+        LogSuccess("Cached file target is the same as resolved one");
+    else
+        LogError("Cached file target differs: {} vs {}", status, status_cached);
+
+    for (const char *path : {"/stc/dirlink/file", "/stc/./dirlink/file"})
+    {
+        if (int status = qfs.Resolve(path, res); 0 == status && "/stc/dir/file" == res.local_path && "file" == res.leaf)
+            LogSuccess("Walk continued from directory target: {}", path);
+        else
+            LogError("Walk from directory target failed: {} {}", path, status);
+    }
+
+    for (const char *path : {"/stc/mntlink/file", "/stc/./mntlink/file"})
+    {
+        if (int status = qfs.Resolve(path, res); 0 == status && res.mountpoint == part && "/file" == res.local_path)
+            LogSuccess("Walk continued from mounted root target: {}", path);
+        else
+            LogError("Walk from mounted root target failed: {} {}", path, status);
+    }
+
+    qfs.Operation.Unlink("/stc/dir/file");
+
+    if (int status = qfs.Resolve("/stc/filelink", res); -QUASI_ENOENT == status && nullptr == res.node)
+        LogSuccess("Unlinked target is not returned from cache");
+    else
+        LogError("Stale target returned after unlink: {}", status);
+
+    qfs.Operation.Close(qfs.Operation.Creat("/stc/dir/file"));
+
+    if (int status = qfs.Resolve("/stc/filelink", res); 0 == status && nullptr != res.node && res.node != res_cached.node)
+        LogSuccess("Recreated target resolved");
+    else
+        LogError("Recreated target not resolved: {}", status);
+
+    qfs.Operation.LinkSymbolic("/stc/loop_b", "/stc/loop_a");
+    qfs.Operation.LinkSymbolic("/stc/loop_a", "/stc/loop_b");
+
+    if (int status = qfs.Resolve("/stc/loop_a/file", res); -QUASI_ELOOP == status)
+        LogSuccess("Symlink loop detected");
+    else
+        LogError("Symlink loop returned {}", status);
+
+    // same partition mounted in another QFS, absolute target belongs to whoever follows the link
+    {
+        partition_ptr shared = Partition::Create();
+        QFS other{};
+        qfs.Operation.MKDir("/stc/shared");
+        other.Operation.MKDir("/shared");
+        other.Operation.MKDir("/stc");
+        other.Operation.MKDir("/stc/dir");
+        qfs.Mount("/stc/shared", shared);
+        other.Mount("/shared", shared);
+        shared->touch(shared->GetRoot(), "abs", Symlink::Create("/stc/dir"));
+
+        Resolved mine;
+        Resolved theirs;
+        qfs.Resolve("/stc/shared/abs", mine);
+        other.Resolve("/shared/abs", theirs);
+        Resolved expected;
+        other.Resolve("/stc/dir", expected);
+        TEST(nullptr != theirs.node && expected.node == theirs.node && mine.node != theirs.node,
+             "Target cached by another QFS not reused", "Link in shared partition followed into the wrong tree");
+
+        qfs.Unmount("/stc/shared");
+        qfs.Operation.RMDir("/stc/shared");
+    }
+
+    qfs.Operation.Unlink("/stc/loop_a");
+    qfs.Operation.Unlink("/stc/loop_b");
+    qfs.Operation.Unlink("/stc/mnt/file");
+    qfs.Unmount("/stc/mnt");
+    qfs.Operation.Unlink("/stc/mntlink");
+    qfs.Operation.Unlink("/stc/dirlink");
+    qfs.Operation.Unlink("/stc/filelink");
+    qfs.Operation.Unlink("/stc/dir/file");
+    qfs.Operation.RMDir("/stc/dir");
+    qfs.Operation.RMDir("/stc/mnt");
+    qfs.Operation.RMDir("/stc");
+}
+
 //
 // Files (I/O)
 //
@@ -1137,4 +1685,994 @@ void TestDirOpen(QFS &qfs)
         LogError("not a dir, QUASI_O_DIRECTORY: {}", status);
 }
 
-void TestDirOps(QFS &qfs) { UNIMPLEMENTED(); }
\ No newline at end of file
+void TestDirOps(QFS &qfs) { UNIMPLEMENTED(); }
+
+void TestDirGetDents(QFS &qfs)
+{
+    LogTest("Dir getdents");
+
+    const int file_count = 300;
+    // small buffer, forces many calls
+    alignas(8) char buffer[512];
+
+    qfs.Operation.MKDir("/gd");
+    qfs.Operation.MKDir("/gd/sub");
+    for (int idx = 0; idx < file_count; idx++)
+        qfs.Operation.Close(qfs.Operation.Creat("/gd/entry_" + std::to_string(idx)));
+
+    // name -> times seen
+    std::map<std::string, int> seen{};
+    bool records_ok = true;
+    int calls = 0;
+
+    int fd = qfs.Operation.Open("/gd", QUASI_O_RDONLY | QUASI_O_DIRECTORY);
+    quasi_ssize_t bytes;
+    while ((bytes = qfs.Operation.GetDents(fd, buffer, sizeof(buffer))) > 0)
+    {
+        calls++;
+        for (quasi_ssize_t offset = 0; offset < bytes;)
+        {
+            dirent_t *record = reinterpret_cast<dirent_t *>(buffer + offset);
+            std::string name = record->d_name;
+            seen[name]++;
+
+            if (0 != record->d_reclen % 8 || (name == "sub" && 4 != record->d_type) || (name.starts_with("entry_") && 8 != record->d_type))
+                records_ok = false;
+
+            offset += record->d_reclen;
+        }
+    }
+
+    bool all_once = file_count + 3 == seen.size();
+    for (auto &[name, count] : seen)
+        all_once &= 1 == count;
+
+    if (0 == bytes && all_once && calls > 1)
+        LogSuccess("Listed {} entries in {} calls", seen.size(), calls);
+    else
+        LogError("Listing incomplete: {} entries, status {}", seen.size(), bytes);
+
+    if (records_ok)
+        LogSuccess("Record length and type are correct");
+    else
+        LogError("Malformed records");
+
+    // resume from d_off of the first record
+    qfs.Operation.LSeek(fd, 0, SeekOrigin::ORIGIN);
+    qfs.Operation.GetDents(fd, buffer, sizeof(buffer));
+    dirent_t *first = reinterpret_cast<dirent_t *>(buffer);
+    std::string second_name = reinterpret_cast<dirent_t *>(buffer + first->d_reclen)->d_name;
+    qfs.Operation.LSeek(fd, first->d_off, SeekOrigin::ORIGIN);
+    qfs.Operation.GetDents(fd, buffer, sizeof(buffer));
+
+    if (second_name == reinterpret_cast<dirent_t *>(buffer)->d_name)
+        LogSuccess("Listing resumed from d_off");
+    else
+        LogError("Listing resumed at {} instead of {}", reinterpret_cast<dirent_t *>(buffer)->d_name, second_name);
+
+    if (quasi_ssize_t status = qfs.Operation.GetDents(fd, buffer, 8); -QUASI_EINVAL == status)
+        LogSuccess("Buffer too small for a record");
+    else
+        LogError("Buffer too small for a record returned {}", status);
+
+    // removing entries while listing must not skip the remaining ones
+    qfs.Operation.LSeek(fd, 0, SeekOrigin::ORIGIN);
+    int removed = 0;
+    while ((bytes = qfs.Operation.GetDents(fd, buffer, sizeof(buffer))) > 0)
+    {
+        for (quasi_ssize_t offset = 0; offset < bytes;)
+        {
+            dirent_t *record = reinterpret_cast<dirent_t *>(buffer + offset);
+            if (std::string_view(record->d_name).starts_with("entry_"))
+                removed += 0 == qfs.Operation.Unlink(std::string("/gd/") + record->d_name);
+            offset += record->d_reclen;
+        }
+    }
+
+    if (file_count == removed)
+        LogSuccess("Removed every entry while listing");
+    else
+        LogError("Removed {}/{} entries while listing", removed, file_count);
+
+    qfs.Operation.Close(fd);
+
+    int file_fd = qfs.Operation.Creat("/gd/file");
+    if (quasi_ssize_t status = qfs.Operation.GetDents(file_fd, buffer, sizeof(buffer)); -QUASI_ENOTDIR == status)
+        LogSuccess("Listing a file rejected");
+    else
+        LogError("Listing a file returned {}", status);
+    qfs.Operation.Close(file_fd);
+
+    qfs.Operation.Unlink("/gd/file");
+    qfs.Operation.RMDir("/gd/sub");
+    qfs.Operation.RMDir("/gd");
+}
+
+void TestDirStats(QFS &qfs)
+{
+    LogTest("Dir statistics");
+
+    VirtualMount mount(qfs, "/dsm");
+
+    Resolved res;
+    quasi_stat_t st;
+    alignas(8) char buffer[4096];
+
+    qfs.Operation.MKDir("/dsm/ds");
+    qfs.Operation.MKDir("/dsm/ds/sub1");
+    qfs.Operation.MKDir("/dsm/ds/sub2");
+    for (const char *name : {"/dsm/ds/a", "/dsm/ds/b", "/dsm/ds/c"})
+        qfs.Operation.Close(qfs.Operation.Creat(name));
+    qfs.Operation.LinkSymbolic("/dsm/ds/a", "/dsm/ds/link");
+    qfs.ForceInsert("/dsm/ds", "null", std::make_shared<Devices::DevStdout>());
+
+    qfs.Resolve("/dsm/ds", res);
+    dir_ptr dir = std::static_pointer_cast<Directory>(res.node);
+    const Directory::EntryCounts &counts = dir->counts;
+
+    if (3 == counts.files && 2 == counts.dirs && 1 == counts.links && 1 == counts.devices && 0 == counts.other)
+        LogSuccess("Entry counts by type are correct");
+    else
+        LogError("Entry counts: {} files, {} dirs, {} links, {} devices, {} other", counts.files, counts.dirs, counts.links, counts.devices, counts.other);
+
+    int fd = qfs.Operation.Open("/dsm/ds", QUASI_O_RDONLY | QUASI_O_DIRECTORY);
+    quasi_ssize_t listed = qfs.Operation.GetDents(fd, buffer, sizeof(buffer));
+    qfs.Operation.Close(fd);
+    qfs.Operation.Stat("/dsm/ds", &st);
+
+    if (listed == qfs.GetDirectorySize("/dsm/ds") && listed == st.st_size)
+        LogSuccess("Directory size matches getdents output: {}", listed);
+    else
+        LogError("Directory size {} / stat {} doesn't match getdents output {}", qfs.GetDirectorySize("/dsm/ds"), st.st_size, listed);
+
+    if (int status = qfs.Operation.RMDir("/dsm/ds"); -QUASI_ENOTEMPTY == status)
+        LogSuccess("Non-empty directory not removed");
+    else
+        LogError("Non-empty directory rmdir returned {}", status);
+
+    if (quasi_ssize_t status = qfs.GetDirectorySize("/dsm/ds/a"); -QUASI_ENOTDIR == status)
+        LogSuccess("Directory size of a file rejected");
+    else
+        LogError("Directory size of a file returned {}", status);
+
+    for (const char *name : {"/dsm/ds/a", "/dsm/ds/b", "/dsm/ds/c", "/dsm/ds/link", "/dsm/ds/null"})
+        qfs.Operation.Unlink(name);
+    qfs.Operation.RMDir("/dsm/ds/sub1");
+    qfs.Operation.RMDir("/dsm/ds/sub2");
+
+    // only . and .. left
+    // record sizes are unsigned, GetDirectorySize is signed to carry errors
+    if (dir->is_empty() && static_cast<quasi_ssize_t>(Directory::dirent_size(1) + Directory::dirent_size(2)) == qfs.GetDirectorySize("/dsm/ds"))
+        LogSuccess("Emptied directory reports only . and ..");
+    else
+        LogError("Emptied directory isn't empty, size {}", qfs.GetDirectorySize("/dsm/ds"));
+
+    if (int status = qfs.Operation.RMDir("/dsm/ds"); 0 == status)
+        LogSuccess("Emptied directory removed");
+    else
+        LogError("Emptied directory rmdir returned {}", status);
+}
+
+void TestFileBulkIO(QFS &qfs)
+{
+    LogTest("Bulk file I/O");
+
+    const quasi_size_t pattern_size = 1024 * 1024 + 13;
+    std::vector<char> pattern(pattern_size);
+    std::vector<char> readback(pattern_size);
+    for (quasi_size_t idx = 0; idx < pattern_size; idx++)
+        pattern[idx] = static_cast<char>(idx * 31 + (idx >> 8));
+
+    int fd = qfs.Operation.Open("/bulk", QUASI_O_CREAT | QUASI_O_RDWR);
+
+    // odd-sized chunks, so every write lands at an unaligned offset
+    const quasi_size_t chunk = 4093;
+    quasi_size_t written = 0;
+    while (written < pattern_size)
+    {
+        quasi_size_t amt = std::min(chunk, pattern_size - written);
+        if (qfs.Operation.PWrite(fd, pattern.data() + written, amt, written) != static_cast<quasi_ssize_t>(amt))
+            break;
+        written += amt;
+    }
+
+    quasi_size_t read = 0;
+    while (read < pattern_size)
+    {
+        quasi_ssize_t br = qfs.Operation.PRead(fd, readback.data() + read, chunk * 3, read);
+        if (br <= 0)
+            break;
+        read += br;
+    }
+
+    if (written == pattern_size && read == pattern_size && 0 == memcmp(pattern.data(), readback.data(), pattern_size))
+        LogSuccess("Chunked readback matches");
+    else
+        LogError("Chunked readback mismatch: written {}, read {} out of {}", written, read, pattern_size);
+
+    if (quasi_ssize_t br = qfs.Operation.PRead(fd, readback.data(), 100, pattern_size - 10); 10 == br)
+        LogSuccess("Short read at EOF");
+    else
+        LogError("Short read at EOF returned {}", br);
+
+    if (quasi_ssize_t br = qfs.Operation.PRead(fd, readback.data(), 100, pattern_size + 10); 0 == br)
+        LogSuccess("Read past EOF returns 0");
+    else
+        LogError("Read past EOF returned {}", br);
+
+    // write past EOF, gap must be zero-filled
+    qfs.Operation.PWrite(fd, "X", 1, pattern_size + 100);
+    quasi_stat_t st;
+    qfs.Operation.FStat(fd, &st);
+    quasi_ssize_t br = qfs.Operation.PRead(fd, readback.data(), 101, pattern_size);
+    bool gap_zeroed = std::all_of(readback.begin(), readback.begin() + 100, [](char c)
+                                  { return 0 == c; });
+
+    if (pattern_size + 101 == st.st_size && 101 == br && gap_zeroed && 'X' == readback[100])
+        LogSuccess("Write past EOF zero-fills the gap");
+    else
+        LogError("Write past EOF: size {}, read {}, gap zeroed {}", st.st_size, br, gap_zeroed);
+
+    qfs.Operation.Close(fd);
+    qfs.Operation.Unlink("/bulk");
+}
+
+void TestFilePages(QFS &qfs)
+{
+    LogTest("Paged file storage");
+
+    VirtualMount mount(qfs, "/pagem");
+
+    const quasi_size_t page = RegularFile::PAGE_SIZE;
+    std::vector<char> buffer(page * 3, 'A');
+    std::vector<char> readback(page * 3);
+
+    int fd = qfs.Operation.Open("/pagem/paged", QUASI_O_CREAT | QUASI_O_RDWR);
+
+    // straddles two page boundaries
+    qfs.Operation.PWrite(fd, buffer.data(), page + 2, page - 1);
+    quasi_ssize_t br = qfs.Operation.PRead(fd, readback.data(), page * 3, 0);
+    bool head_zeroed = std::all_of(readback.begin(), readback.begin() + page - 1, [](char c)
+                                   { return 0 == c; });
+    bool body_intact = std::all_of(readback.begin() + page - 1, readback.begin() + 2 * page + 1, [](char c)
+                                   { return 'A' == c; });
+
+    if (static_cast<quasi_ssize_t>(2 * page + 1) == br && head_zeroed && body_intact)
+        LogSuccess("Write across page boundaries");
+    else
+        LogError("Write across page boundaries: read {}, head zeroed {}, body intact {}", br, head_zeroed, body_intact);
+
+    // shrink into the middle of a page, then grow back
+    qfs.Operation.FTruncate(fd, page + 10);
+    qfs.Operation.FTruncate(fd, page * 2);
+    br = qfs.Operation.PRead(fd, readback.data(), page * 3, 0);
+    bool tail_zeroed = std::all_of(readback.begin() + page + 10, readback.begin() + 2 * page, [](char c)
+                                   { return 0 == c; });
+
+    if (static_cast<quasi_ssize_t>(2 * page) == br && 'A' == readback[page + 9] && tail_zeroed)
+        LogSuccess("Truncated tail reads back as zeros");
+    else
+        LogError("Truncated tail: read {}, tail zeroed {}", br, tail_zeroed);
+
+    // grow far past allocated pages
+    qfs.Operation.FTruncate(fd, page * 64);
+    br = qfs.Operation.PRead(fd, readback.data(), page, page * 40);
+    bool hole_zeroed = std::all_of(readback.begin(), readback.begin() + page, [](char c)
+                                   { return 0 == c; });
+
+    if (static_cast<quasi_ssize_t>(page) == br && hole_zeroed)
+        LogSuccess("Extended file reads back as zeros");
+    else
+        LogError("Extended file: read {}, zeroed {}", br, hole_zeroed);
+
+    qfs.Operation.Close(fd);
+    qfs.Operation.Unlink("/pagem/paged");
+}
+
+void TestSparseFile(QFS &qfs)
+{
+    LogTest("Sparse files");
+
+    VirtualMount mount(qfs, "/sparsem");
+
+    const quasi_off_t page = RegularFile::PAGE_SIZE;
+    const quasi_off_t blocks = RegularFile::PAGE_SIZE / 512;
+    const quasi_off_t size = 1024 * 1024 * 1024;
+    const quasi_off_t far_data = 512 * 1024 * 1024 + 100;
+    quasi_stat_t st;
+    char buffer[256];
+
+    int fd = qfs.Operation.Open("/sparsem/sparse", QUASI_O_CREAT | QUASI_O_RDWR);
+    qfs.Operation.FTruncate(fd, size);
+    qfs.Operation.FStat(fd, &st);
+    TEST(size == st.st_size && 0 == st.st_blocks, "Pre-sized file allocates nothing", "Pre-sized file: size {}, blocks {}", st.st_size, st.st_blocks);
+
+    qfs.Operation.PWrite(fd, "near", 4, 3 * page + 10);
+    qfs.Operation.PWrite(fd, "far", 3, far_data);
+    memset(buffer, 0, sizeof(buffer));
+    qfs.Operation.PWrite(fd, buffer, sizeof(buffer), 100 * page);
+    qfs.Operation.FStat(fd, &st);
+    TEST(2 * blocks == st.st_blocks, "Only written pages allocated", "Expected {} blocks, got {}", 2 * blocks, st.st_blocks);
+
+    memset(buffer, 'x', sizeof(buffer));
+    quasi_ssize_t br = qfs.Operation.PRead(fd, buffer, sizeof(buffer), 200 * page);
+    bool zeroed = std::all_of(buffer, buffer + sizeof(buffer), [](char c)
+                              { return 0 == c; });
+    qfs.Operation.FStat(fd, &st);
+    TEST(sizeof(buffer) == br && zeroed && 2 * blocks == st.st_blocks, "Hole reads back as zeros", "Hole read {}, zeroed {}, blocks {}", br, zeroed, st.st_blocks);
+
+    TEST(int status = qfs.Operation.LSeek(fd, 0, SeekOrigin::DATA); 3 * page == status, "SEEK_DATA from start", "SEEK_DATA from start returned {}", status);
+    TEST(int status = qfs.Operation.LSeek(fd, 3 * page + 20, SeekOrigin::DATA); 3 * page + 20 == status, "SEEK_DATA inside data", "SEEK_DATA inside data returned {}", status);
+    TEST(int status = qfs.Operation.LSeek(fd, 3 * page + 20, SeekOrigin::HOLE); 4 * page == status, "SEEK_HOLE after data", "SEEK_HOLE after data returned {}", status);
+    TEST(int status = qfs.Operation.LSeek(fd, 4 * page, SeekOrigin::DATA); far_data / page * page == status, "SEEK_DATA skips hole", "SEEK_DATA skipping hole returned {}", status);
+    TEST(int status = qfs.Operation.LSeek(fd, far_data + page, SeekOrigin::DATA); -QUASI_ENXIO == status, "SEEK_DATA past last data", "SEEK_DATA past last data returned {}", status);
+    TEST(int status = qfs.Operation.LSeek(fd, far_data + page, SeekOrigin::HOLE); far_data + page == status, "SEEK_HOLE in trailing hole", "SEEK_HOLE in trailing hole returned {}", status);
+    TEST(int status = qfs.Operation.LSeek(fd, size, SeekOrigin::HOLE); -QUASI_ENXIO == status, "SEEK_HOLE at EOF", "SEEK_HOLE at EOF returned {}", status);
+    TEST(int status = qfs.Operation.Tell(fd); far_data + page == status, "Failed seek keeps position", "Position after failed seek: {}", status);
+
+    qfs.Operation.FTruncate(fd, 1024 * 1024);
+    qfs.Operation.FStat(fd, &st);
+    TEST(blocks == st.st_blocks, "Truncate releases pages", "Blocks after truncate: {}", st.st_blocks);
+
+    qfs.Operation.Close(fd);
+    qfs.Operation.Unlink("/sparsem/sparse");
+}
+
+void TestClone(QFS &qfs)
+{
+    LogTest("Copy-on-write clone");
+
+    VirtualMount mount(qfs, "/clonem");
+
+    const quasi_size_t page = RegularFile::PAGE_SIZE;
+    const quasi_size_t size = page * 3 + 100;
+    std::vector<char> pattern(size);
+    std::vector<char> readback(size);
+    for (quasi_size_t idx = 0; idx < size; idx++)
+        pattern[idx] = static_cast<char>('a' + idx % 26);
+
+    int src_fd = qfs.Operation.Open("/clonem/clone_src", QUASI_O_CREAT | QUASI_O_RDWR);
+    int dst_fd = qfs.Operation.Open("/clonem/clone_dst", QUASI_O_CREAT | QUASI_O_RDWR);
+    qfs.Operation.PWrite(src_fd, pattern.data(), size, 0);
+    // stale contents must be dropped
+    qfs.Operation.PWrite(dst_fd, "stale", 5, page * 10);
+
+    TEST(int status = qfs.Operation.Clone(src_fd, dst_fd); 0 == status, "Cloned file", "Clone returned {}", status);
+
+    quasi_stat_t src_st, dst_st;
+    qfs.Operation.FStat(src_fd, &src_st);
+    qfs.Operation.FStat(dst_fd, &dst_st);
+    quasi_ssize_t br = qfs.Operation.PRead(dst_fd, readback.data(), size, 0);
+    TEST(size == dst_st.st_size && src_st.st_blocks == dst_st.st_blocks && size == br && 0 == memcmp(pattern.data(), readback.data(), size),
+         "Clone matches source", "Clone: size {}, blocks {}/{}, read {}", dst_st.st_size, dst_st.st_blocks, src_st.st_blocks, br);
+
+    // each side writes to a different shared page
+    qfs.Operation.PWrite(dst_fd, "DST", 3, 10);
+    qfs.Operation.PWrite(src_fd, "SRC", 3, page * 2 + 10);
+
+    qfs.Operation.PRead(src_fd, readback.data(), size, 0);
+    TEST(0 == memcmp(pattern.data(), readback.data(), page * 2) && 0 == memcmp(readback.data() + page * 2 + 10, "SRC", 3),
+         "Write to clone doesn't leak into source", "Source was modified by write to clone");
+
+    qfs.Operation.PRead(dst_fd, readback.data(), size, 0);
+    TEST(0 == memcmp(readback.data() + 10, "DST", 3) && 0 == memcmp(pattern.data() + page, readback.data() + page, size - page),
+         "Write to source doesn't leak into clone", "Clone was modified by write to source");
+
+    // shrinking zeroes the tail of a shared page
+    qfs.Operation.FTruncate(src_fd, page + 10);
+    qfs.Operation.PRead(dst_fd, readback.data(), size, 0);
+    TEST(0 == memcmp(pattern.data() + page, readback.data() + page, page),
+         "Truncating source doesn't touch clone", "Clone was modified by truncating source");
+
+    int ro_fd = qfs.Operation.Open("/clonem/clone_dst", QUASI_O_RDONLY);
+    int dir_fd = qfs.Operation.Open("/", QUASI_O_RDONLY | QUASI_O_DIRECTORY);
+    TEST(int status = qfs.Operation.Clone(src_fd, ro_fd); -QUASI_EBADF == status, "Read-only destination rejected", "Clone into read-only returned {}", status);
+    TEST(int status = qfs.Operation.Clone(dir_fd, dst_fd); -QUASI_EISDIR == status, "Directory source rejected", "Clone from directory returned {}", status);
+
+    for (int fd : {src_fd, dst_fd, ro_fd, dir_fd})
+        qfs.Operation.Close(fd);
+    qfs.Operation.Unlink("/clonem/clone_src");
+    qfs.Operation.Unlink("/clonem/clone_dst");
+}
+
+void TestMap(QFS &qfs)
+{
+    LogTest("File mapping");
+
+    VirtualMount mount(qfs, "/mapm");
+
+    const quasi_size_t page = RegularFile::PAGE_SIZE;
+    const quasi_size_t size = page * 3 + 100;
+    std::vector<char> pattern(page * 2);
+    std::vector<char> readback(size);
+    for (quasi_size_t idx = 0; idx < pattern.size(); idx++)
+        pattern[idx] = static_cast<char>('A' + idx % 26);
+
+    // page 2 is a hole
+    int fd = qfs.Operation.Open("/mapm/mapped", QUASI_O_CREAT | QUASI_O_RDWR);
+    qfs.Operation.PWrite(fd, pattern.data(), pattern.size(), 0);
+    qfs.Operation.FTruncate(fd, size);
+
+    auto collect = [](const FileMapping &mapping)
+    {
+        std::vector<char> out{};
+        for (size_t idx = 0; idx < mapping.Segments(); idx++)
+        {
+            std::span<const char> segment = mapping.Segment(idx);
+            out.insert(out.end(), segment.begin(), segment.end());
+        }
+        return out;
+    };
+
+    FileMapping ro_map;
+    TEST(int status = qfs.Map(fd, page - 10, page * 2 + 20, QUASI_PROT_READ, ro_map); 0 == status, "Mapped read-only", "Map returned {}", status);
+
+    qfs.Operation.PRead(fd, readback.data(), page * 2 + 20, page - 10);
+    std::vector<char> mapped = collect(ro_map);
+    TEST(4 == ro_map.Segments() && mapped.size() == page * 2 + 20 && 0 == memcmp(mapped.data(), readback.data(), mapped.size()),
+         "Mapped range matches file", "Mapped range: {} segments, {} bytes", ro_map.Segments(), mapped.size());
+
+    qfs.Operation.PWrite(fd, "inplace", 7, page + 5);
+    mapped = collect(ro_map);
+    TEST(ro_map.IsValid() && 0 == memcmp(mapped.data() + 15, "inplace", 7), "Mapping sees file writes", "Mapping didn't see file write");
+    TEST(ro_map.WritableSegment(0).empty(), "Read-only mapping isn't writable", "Read-only mapping returned writable segment");
+
+    FileMapping rw_map;
+    TEST(int status = qfs.Map(fd, page * 2 + 10, 100, QUASI_PROT_READ | QUASI_PROT_WRITE, rw_map); 0 == status, "Mapped hole for writing", "Map returned {}", status);
+    std::span<char> segment = rw_map.WritableSegment(0);
+    memcpy(segment.data(), "mapped", 6);
+    qfs.Operation.PRead(fd, readback.data(), 6, page * 2 + 10);
+    TEST(0 == memcmp(readback.data(), "mapped", 6), "Write through mapping lands in file", "File doesn't see write through mapping");
+    TEST(!ro_map.IsValid() && ro_map.Segment(2).empty() && !ro_map.Segment(3).empty(), "Filling mapped hole invalidates its page", "Mapping of filled hole still valid");
+
+    int clone_fd = qfs.Operation.Open("/mapm/mapped_clone", QUASI_O_CREAT | QUASI_O_RDWR);
+    TEST(int status = qfs.Operation.Clone(fd, clone_fd); -QUASI_EBUSY == status, "Clone of writably mapped file rejected", "Clone returned {}", status);
+    rw_map.Unmap();
+    TEST(int status = qfs.Operation.Clone(fd, clone_fd); 0 == status, "Clone after unmap", "Clone returned {}", status);
+
+    // page is shared now, writing to it moves it
+    qfs.Map(fd, 0, 100, QUASI_PROT_READ, ro_map);
+    qfs.Operation.PWrite(fd, "cow", 3, 0);
+    TEST(!ro_map.IsValid(), "Copy-on-write invalidates mapping", "Mapping valid after copy-on-write");
+
+    qfs.Map(fd, page, 100, QUASI_PROT_READ, ro_map);
+    FileMapping moved = std::move(ro_map);
+    qfs.Operation.FTruncate(fd, page + 50);
+    TEST(!moved.IsValid() && moved.Segment(0).empty() && 0 == ro_map.Segments(), "Truncate invalidates mapping", "Mapping valid after truncate");
+
+    int ro_fd = qfs.Operation.Open("/mapm/mapped", QUASI_O_RDONLY);
+    int dir_fd = qfs.Operation.Open("/", QUASI_O_RDONLY | QUASI_O_DIRECTORY);
+    FileMapping bad_map;
+    TEST(int status = qfs.Map(ro_fd, 0, 10, QUASI_PROT_READ | QUASI_PROT_WRITE, bad_map); -QUASI_EACCES == status, "Writable map of read-only fd rejected", "Map returned {}", status);
+    TEST(int status = qfs.Map(ro_fd, 0, size, QUASI_PROT_READ, bad_map); -QUASI_ENXIO == status, "Map past EOF rejected", "Map returned {}", status);
+    TEST(int status = qfs.Map(dir_fd, 0, 10, QUASI_PROT_READ, bad_map); -QUASI_ENODEV == status, "Map of directory rejected", "Map returned {}", status);
+
+    for (int open_fd : {fd, clone_fd, ro_fd, dir_fd})
+        qfs.Operation.Close(open_fd);
+    qfs.Operation.Unlink("/mapm/mapped");
+    qfs.Operation.Unlink("/mapm/mapped_clone");
+}
+
+void TestVectoredIO(QFS &qfs)
+{
+    LogTest("Vectored I/O");
+
+    char header[] = "HEADER:";
+    std::vector<char> body(RegularFile::PAGE_SIZE + 33, 'b');
+    char footer[] = ":FOOTER";
+    const quasi_ssize_t total = 7 + body.size() + 7;
+
+    quasi_iovec_t out[] = {{header, 7}, {body.data(), body.size()}, {footer, 7}};
+
+    int fd = qfs.Operation.Open("/vectored", QUASI_O_CREAT | QUASI_O_RDWR);
+    TEST(quasi_ssize_t bw = qfs.Operation.WriteV(fd, out, 3); total == bw, "Gathered write", "WriteV returned {} out of {}", bw, total);
+    TEST(quasi_ssize_t pos = qfs.Operation.Tell(fd); total == pos, "WriteV advances position", "Position after WriteV: {}", pos);
+
+    // split differently than written
+    char first[4]{};
+    std::vector<char> middle(RegularFile::PAGE_SIZE);
+    char last[64]{};
+    quasi_iovec_t in[] = {{first, sizeof(first)}, {middle.data(), middle.size()}, {last, sizeof(last)}};
+
+    qfs.Operation.LSeek(fd, 0, SeekOrigin::ORIGIN);
+    quasi_ssize_t br = qfs.Operation.ReadV(fd, in, 3);
+    quasi_size_t tail = total - sizeof(first) - middle.size();
+    TEST(total == br && 0 == memcmp(first, "HEAD", 4) && 'b' == middle.back() && 0 == memcmp(last + tail - 7, footer, 7),
+         "Scattered read, short at EOF", "ReadV returned {} out of {}", br, total);
+    TEST(quasi_ssize_t pos = qfs.Operation.Tell(fd); total == pos, "ReadV advances position", "Position after ReadV: {}", pos);
+
+    quasi_iovec_t patch[] = {{footer, 1}, {header, 6}};
+    qfs.Operation.PWriteV(fd, patch, 2, 1);
+    br = qfs.Operation.PReadV(fd, in, 1, 0);
+    TEST(4 == br && 0 == memcmp(first, "H:HE", 4), "Positional vectored I/O", "PReadV returned {}: {}", br, std::string_view(first, 4));
+    TEST(quasi_ssize_t pos = qfs.Operation.Tell(fd); total == pos, "Positional variants keep position", "Position after PReadV: {}", pos);
+
+    TEST(quasi_ssize_t status = qfs.Operation.ReadV(fd, in, -1); -QUASI_EINVAL == status, "Negative iovcnt rejected", "ReadV returned {}", status);
+    TEST(quasi_ssize_t status = qfs.Operation.ReadV(fd, in, QUASI_IOV_MAX + 1); -QUASI_EINVAL == status, "iovcnt over limit rejected", "ReadV returned {}", status);
+
+    qfs.Operation.Close(fd);
+    qfs.Operation.Unlink("/vectored");
+}
+
+void TestLargeFile(QFS &qfs)
+{
+    LogTest("Files over 4 GiB");
+
+    const quasi_off_t GiB = 1024LL * 1024 * 1024;
+    quasi_stat_t st;
+    char buffer[16]{};
+
+    //
+    // Virtual, sparse
+    //
+
+    {
+        VirtualMount mount(qfs, "/largev");
+
+        int fd = qfs.Operation.Open("/largev/archive", QUASI_O_CREAT | QUASI_O_RDWR);
+        qfs.Operation.FTruncate(fd, 6 * GiB);
+        qfs.Operation.PWrite(fd, "beyond", 6, 5 * GiB + 3);
+        qfs.Operation.FStat(fd, &st);
+
+        TEST(6 * GiB == st.st_size && RegularFile::PAGE_SIZE / 512 == st.st_blocks, "Sparse 6 GiB file", "Sparse file: size {}, blocks {}", st.st_size, st.st_blocks);
+        TEST(quasi_ssize_t br = qfs.Operation.PRead(fd, buffer, 6, 5 * GiB + 3); 6 == br && 0 == memcmp(buffer, "beyond", 6), "Read past 4 GiB", "Read past 4 GiB returned {}", br);
+        TEST(quasi_off_t pos = qfs.Operation.LSeek(fd, 0, SeekOrigin::END); 6 * GiB == pos, "Seek to end past 4 GiB", "Seek to end returned {}", pos);
+        TEST(quasi_off_t pos = qfs.Operation.LSeek(fd, 0, SeekOrigin::DATA); 5 * GiB == pos, "SEEK_DATA past 4 GiB", "SEEK_DATA returned {}", pos);
+        TEST(quasi_ssize_t size = qfs.GetSize(fd); 6 * GiB == size, "Size past 4 GiB", "GetSize returned {}", size);
+
+        qfs.Operation.Close(fd);
+        qfs.Operation.Unlink("/largev/archive");
+    }
+
+    //
+    // Host-bound, host decides how sparse it is
+    //
+
+    fs::path host_dir = fs::temp_directory_path() / "quasifs_large_host";
+    fs::remove_all(host_dir);
+    fs::create_directories(host_dir);
+    partition_ptr host_part = Partition::Create(host_dir);
+    qfs.Operation.MKDir("/largeh");
+    qfs.Mount("/largeh", host_part, MountOptions::MOUNT_RW);
+
+    int fd = qfs.Operation.Open("/largeh/archive", QUASI_O_CREAT | QUASI_O_RDWR);
+    int truncate_status = qfs.Operation.FTruncate(fd, 5 * GiB);
+    qfs.Operation.Stat("/largeh/archive", &st);
+
+    // don't fill host's disk with 5 GiB of zeroes
+    if (0 != truncate_status || st.st_blocks * 512 >= GiB)
+        Log("Host can't truncate sparse ({}, {} blocks), skipping host-bound part", truncate_status, st.st_blocks);
+    else
+    {
+        TEST(quasi_ssize_t bw = qfs.Operation.PWrite(fd, "END!", 4, 5 * GiB - 4); 4 == bw, "Host write past 4 GiB", "Host write past 4 GiB returned {}", bw);
+        memset(buffer, 0, sizeof(buffer));
+        TEST(quasi_ssize_t br = qfs.Operation.PRead(fd, buffer, sizeof(buffer), 5 * GiB - 4); 4 == br && 0 == memcmp(buffer, "END!", 4), "Host read past 4 GiB", "Host read past 4 GiB returned {}", br);
+        TEST(quasi_off_t pos = qfs.Operation.LSeek(fd, 0, SeekOrigin::END); 5 * GiB == pos, "Host seek to end past 4 GiB", "Host seek to end returned {}", pos);
+        qfs.Operation.Stat("/largeh/archive", &st);
+        TEST(5 * GiB == st.st_size && 5 * GiB == static_cast<quasi_off_t>(fs::file_size(host_dir / "archive")), "Host file size past 4 GiB", "Host file size: {}", st.st_size);
+    }
+
+    qfs.Operation.Close(fd);
+    qfs.Operation.Unlink("/largeh/archive");
+    qfs.Unmount("/largeh");
+    qfs.Operation.RMDir("/largeh");
+    fs::remove_all(host_dir);
+}
+
+void TestInlineFile(QFS &qfs)
+{
+    LogTest("Inline file storage");
+
+    VirtualMount mount(qfs, "/inlinem");
+
+    const quasi_off_t blocks = RegularFile::PAGE_SIZE / 512;
+    const quasi_size_t inline_size = RegularFile::INLINE_SIZE;
+    quasi_stat_t st;
+    char buffer[256];
+
+    int fd = qfs.Operation.Open("/inlinem/lock", QUASI_O_CREAT | QUASI_O_RDWR);
+    qfs.Operation.Write(fd, "{\"pid\":1234}", 12);
+    qfs.Operation.FStat(fd, &st);
+    memset(buffer, 0, sizeof(buffer));
+    quasi_ssize_t br = qfs.Operation.PRead(fd, buffer, sizeof(buffer), 0);
+    TEST(12 == br && 0 == memcmp(buffer, "{\"pid\":1234}", 12) && 0 == st.st_blocks, "Small file stored inline", "Small file: read {}, blocks {}", br, st.st_blocks);
+
+    // shrink, then grow back within inline buffer
+    qfs.Operation.FTruncate(fd, 4);
+    qfs.Operation.FTruncate(fd, 12);
+    memset(buffer, 'x', sizeof(buffer));
+    br = qfs.Operation.PRead(fd, buffer, sizeof(buffer), 0);
+    bool tail_zeroed = std::all_of(buffer + 4, buffer + 12, [](char c)
+                                   { return 0 == c; });
+    TEST(12 == br && 0 == memcmp(buffer, "{\"pi", 4) && tail_zeroed, "Truncated inline tail reads back as zeros", "Truncated inline tail: read {}, tail zeroed {}", br, tail_zeroed);
+
+    TEST(quasi_off_t pos = qfs.Operation.LSeek(fd, 2, SeekOrigin::DATA); 2 == pos, "SEEK_DATA in inline file", "SEEK_DATA returned {}", pos);
+    TEST(quasi_off_t pos = qfs.Operation.LSeek(fd, 2, SeekOrigin::HOLE); 12 == pos, "SEEK_HOLE in inline file", "SEEK_HOLE returned {}", pos);
+
+    // last byte that still fits, then one past it
+    qfs.Operation.PWrite(fd, "E", 1, inline_size - 1);
+    qfs.Operation.FStat(fd, &st);
+    TEST(static_cast<quasi_off_t>(inline_size) == st.st_size && 0 == st.st_blocks, "Inline buffer filled up", "Full inline buffer: size {}, blocks {}", st.st_size, st.st_blocks);
+
+    qfs.Operation.PWrite(fd, "F", 1, inline_size);
+    qfs.Operation.FStat(fd, &st);
+    memset(buffer, 'x', sizeof(buffer));
+    br = qfs.Operation.PRead(fd, buffer, sizeof(buffer), 0);
+    TEST(static_cast<quasi_ssize_t>(inline_size + 1) == br && 0 == memcmp(buffer, "{\"pi", 4) && 'E' == buffer[inline_size - 1] && 'F' == buffer[inline_size] && blocks == st.st_blocks,
+         "Grown file moved to a page", "Grown file: read {}, blocks {}", br, st.st_blocks);
+
+    // empty file starts inline again
+    qfs.Operation.FTruncate(fd, 0);
+    qfs.Operation.PWrite(fd, "again", 5, 0);
+    qfs.Operation.FStat(fd, &st);
+    memset(buffer, 0, sizeof(buffer));
+    br = qfs.Operation.PRead(fd, buffer, sizeof(buffer), 0);
+    TEST(5 == br && 0 == memcmp(buffer, "again", 5) && 0 == st.st_blocks, "Emptied file goes back inline", "Emptied file: read {}, blocks {}", br, st.st_blocks);
+
+    // clone carries inline contents, and they stay independent
+    int clone_fd = qfs.Operation.Open("/inlinem/lock.clone", QUASI_O_CREAT | QUASI_O_RDWR);
+    qfs.Operation.Clone(fd, clone_fd);
+    qfs.Operation.PWrite(clone_fd, "A", 1, 0);
+    memset(buffer, 0, sizeof(buffer));
+    qfs.Operation.PRead(fd, buffer, 5, 0);
+    char clone_buffer[8]{};
+    br = qfs.Operation.PRead(clone_fd, clone_buffer, sizeof(clone_buffer), 0);
+    TEST(5 == br && 0 == memcmp(buffer, "again", 5) && 0 == memcmp(clone_buffer, "Again", 5), "Inline file cloned", "Inline clone: read {}", br);
+
+    // mapping needs a page
+    FileMapping mapping;
+    int status = qfs.Map(fd, 0, 5, QUASI_PROT_READ, mapping);
+    std::span<const char> segment = mapping.Segment(0);
+    TEST(0 == status && 5 == segment.size() && 0 == memcmp(segment.data(), "again", 5), "Inline file mapped", "Inline map: status {}, segment size {}", status, segment.size());
+    mapping.Unmap();
+
+    // all zeros, still gets a page instead of a pinned hole
+    int zero_fd = qfs.Operation.Open("/inlinem/zeros", QUASI_O_CREAT | QUASI_O_RDWR);
+    qfs.Operation.FTruncate(zero_fd, 16);
+    status = qfs.Map(zero_fd, 0, 16, QUASI_PROT_READ, mapping);
+    qfs.Operation.Write(zero_fd, "seen", 4);
+    segment = mapping.Segment(0);
+    TEST(0 == status && mapping.IsValid() && 16 == segment.size() && 0 == memcmp(segment.data(), "seen", 4), "Write visible through map of zeroed inline file", "Zeroed inline map: status {}, valid {}", status, mapping.IsValid());
+    mapping.Unmap();
+
+    qfs.Operation.Close(zero_fd);
+    qfs.Operation.Close(clone_fd);
+    qfs.Operation.Close(fd);
+    qfs.Operation.Unlink("/inlinem/zeros");
+    qfs.Operation.Unlink("/inlinem/lock.clone");
+    qfs.Operation.Unlink("/inlinem/lock");
+}
+
+void TestCompression(QFS &qfs)
+{
+    LogTest("Idle file compression");
+
+    const quasi_size_t page = RegularFile::PAGE_SIZE;
+
+    // half text, half noise
+    std::vector<char> plain(page);
+    uint32_t seed = 1;
+    for (quasi_size_t idx = 0; idx < page; idx++)
+    {
+        seed = seed * 1103515245 + 12345;
+        plain[idx] = idx < page / 2 ? "quasi filesystem "[idx % 17] : static_cast<char>(seed >> 24);
+    }
+
+    std::vector<char> packed(page * 2);
+    std::vector<char> unpacked(page);
+    quasi_size_t packed_size = LZ::Compress(plain.data(), page, packed.data(), packed.size());
+    quasi_ssize_t unpacked_size = LZ::Decompress(packed.data(), packed_size, unpacked.data(), unpacked.size());
+    TEST(0 != packed_size && packed_size < page && static_cast<quasi_ssize_t>(page) == unpacked_size && plain == unpacked, "LZ round trip", "LZ round trip: packed {}, unpacked {}", packed_size, unpacked_size);
+    TEST(quasi_ssize_t status = LZ::Decompress(packed.data(), packed_size - 1, unpacked.data(), unpacked.size()); -QUASI_EINVAL == status, "LZ rejects truncated input", "Truncated input returned {}", status);
+    TEST(quasi_size_t status = LZ::Compress(plain.data(), page, packed.data(), page / 4); 0 == status, "LZ reports short output buffer", "Short output buffer returned {}", status);
+
+    TEST(int status = Partition::Create(fs::absolute("compress_host"))->SetCompression(1); -QUASI_EOPNOTSUPP == status, "No compression on host-bound partition", "Host-bound partition returned {}", status);
+
+    VirtualMount mount(qfs, "/zm");
+    partition_ptr part = mount.part;
+    part->SetCompression(2);
+
+    // 4 text pages and a page of noise
+    std::vector<char> contents(page * 5);
+    for (quasi_size_t idx = 0; idx < contents.size(); idx++)
+    {
+        seed = seed * 1103515245 + 12345;
+        contents[idx] = idx < page * 4 ? "quasi filesystem "[idx % 17] : static_cast<char>(seed >> 24);
+    }
+    std::vector<char> readback(contents.size());
+    quasi_stat_t st_before, st_after;
+
+    int cold_fd = qfs.Operation.Open("/zm/cold", QUASI_O_CREAT | QUASI_O_RDWR);
+    int hot_fd = qfs.Operation.Open("/zm/hot", QUASI_O_CREAT | QUASI_O_RDWR);
+    qfs.Operation.PWrite(cold_fd, contents.data(), contents.size(), 0);
+    qfs.Operation.PWrite(hot_fd, contents.data(), page, 0);
+    qfs.Operation.FStat(cold_fd, &st_before);
+
+    TEST(quasi_size_t count = part->SweepIdle(); 0 == count, "Nothing compressed before idle limit", "First sweep compressed {} pages", count);
+    qfs.Operation.PRead(hot_fd, readback.data(), page, 0);
+    TEST(quasi_size_t count = part->SweepIdle(); 4 == count, "Idle file compressed", "Second sweep compressed {} pages", count);
+
+    CompressionStats stats = part->GetCompressionStats();
+    qfs.Operation.FStat(cold_fd, &st_after);
+    TEST(4 == stats.pages_packed && 4 * page == stats.original_bytes && stats.Ratio() > 8.0, "Compression ratio", "Compression: {} pages, {} -> {} bytes", stats.pages_packed, stats.original_bytes, stats.packed_bytes);
+    Log("Compression ratio {}", stats.Ratio());
+    TEST(st_before.st_blocks == st_after.st_blocks && st_before.st_size == st_after.st_size, "Compression is invisible to stat", "Stat changed: blocks {} -> {}", st_before.st_blocks, st_after.st_blocks);
+    TEST(quasi_off_t pos = qfs.Operation.LSeek(cold_fd, 0, SeekOrigin::HOLE); static_cast<quasi_off_t>(page * 5) == pos, "Compressed pages aren't holes", "SEEK_HOLE returned {}", pos);
+    qfs.Operation.PRead(hot_fd, readback.data(), page, 0);
+    TEST(quasi_size_t count = part->SweepIdle(); 0 == count, "Idle file compressed only once", "Third sweep compressed {} pages", count);
+    qfs.Operation.Close(hot_fd);
+    qfs.Operation.Unlink("/zm/hot");
+
+    // clone shares compressed pages
+    int clone_fd = qfs.Operation.Open("/zm/cold.clone", QUASI_O_CREAT | QUASI_O_RDWR);
+    qfs.Operation.Clone(cold_fd, clone_fd);
+    std::fill(readback.begin(), readback.end(), 0);
+    qfs.Operation.PRead(clone_fd, readback.data(), readback.size(), 0);
+    TEST(contents == readback, "Compressed file cloned", "Clone of compressed file differs");
+
+    std::fill(readback.begin(), readback.end(), 0);
+    quasi_ssize_t br = qfs.Operation.PRead(cold_fd, readback.data(), readback.size(), 0);
+    stats = part->GetCompressionStats();
+    TEST(static_cast<quasi_ssize_t>(contents.size()) == br && contents == readback && 8 == stats.pages_unpacked && 0 == stats.original_bytes && 0 == stats.packed_bytes,
+         "Compressed file reads back", "Read back {}, unpacked {}, still packed {}", br, stats.pages_unpacked, stats.original_bytes);
+    Log("Average decompression {} ns, worst {} ns", stats.AverageUnpackNs(), stats.unpack_max_ns);
+
+    // truncation drops compressed pages
+    qfs.Operation.Close(clone_fd);
+    qfs.Operation.Unlink("/zm/cold.clone");
+    part->SweepIdle();
+    part->SweepIdle();
+    qfs.Operation.FTruncate(cold_fd, page);
+    stats = part->GetCompressionStats();
+    qfs.Operation.FStat(cold_fd, &st_after);
+    TEST(page == stats.original_bytes && RegularFile::PAGE_SIZE / 512 == st_after.st_blocks, "Truncation drops compressed pages", "After truncation: {} bytes still packed, {} blocks", stats.original_bytes, st_after.st_blocks);
+
+    qfs.Operation.Close(cold_fd);
+    qfs.Operation.Unlink("/zm/cold");
+}
+
+void TestDedup(QFS &qfs)
+{
+    LogTest("Cross-partition deduplication");
+
+    const quasi_size_t page = RegularFile::PAGE_SIZE;
+
+    TEST(int status = Partition::Create(fs::absolute("dedup_host"))->SetDedupStore(DedupStore::Create()); -QUASI_EOPNOTSUPP == status, "No dedup on host-bound partition", "Host-bound partition returned {}", status);
+
+    // per-user copies of the same defaults
+    dedup_store_ptr store = DedupStore::Create();
+    const char *mounts[] = {"/dda", "/ddb", "/ddc"};
+    for (const char *mount : mounts)
+    {
+        partition_ptr part = Partition::Create();
+        qfs.Operation.MKDir(mount);
+        qfs.Mount(mount, part, MountOptions::MOUNT_RW);
+        // last one keeps its own copy
+        if (std::string_view("/ddc") != mount)
+            part->SetDedupStore(store);
+    }
+
+    std::vector<char> contents(page * 3);
+    for (quasi_size_t idx = 0; idx < contents.size(); idx++)
+        contents[idx] = static_cast<char>(idx * 31 / 7);
+    std::vector<char> readback(contents.size());
+
+    for (const char *mount : mounts)
+    {
+        int fd = qfs.Operation.Open(std::string(mount) + "/defaults", QUASI_O_CREAT | QUASI_O_RDWR);
+        qfs.Operation.PWrite(fd, contents.data(), contents.size(), 0);
+        qfs.Operation.Close(fd);
+    }
+
+    DedupStore::Stats stats = store->GetStats();
+    TEST(3 == stats.hits && 3 == stats.unique_pages && 6 == stats.shared_pages, "Identical files stored once", "Dedup: {} hits, {} unique, {} shared", stats.hits, stats.unique_pages, stats.shared_pages);
+
+    // closing again doesn't rehash unchanged file
+    int fd = qfs.Operation.Open("/ddb/defaults", QUASI_O_RDWR);
+    qfs.Operation.Close(fd);
+    TEST(stats.lookups == store->GetStats().lookups, "Unchanged file not rehashed", "Lookups went from {} to {}", stats.lookups, store->GetStats().lookups);
+
+    // copy-on-write keeps the other copy intact
+    fd = qfs.Operation.Open("/ddb/defaults", QUASI_O_RDWR);
+    qfs.Operation.PWrite(fd, "changed", 7, page + 5);
+    qfs.Operation.Close(fd);
+
+    fd = qfs.Operation.Open("/dda/defaults", QUASI_O_RDONLY);
+    quasi_ssize_t br = qfs.Operation.PRead(fd, readback.data(), readback.size(), 0);
+    qfs.Operation.Close(fd);
+    TEST(static_cast<quasi_ssize_t>(contents.size()) == br && contents == readback, "Shared copy unaffected by write", "Shared copy: read {}, intact {}", br, contents == readback);
+
+    fd = qfs.Operation.Open("/ddb/defaults", QUASI_O_RDONLY);
+    qfs.Operation.PRead(fd, readback.data(), readback.size(), 0);
+    qfs.Operation.Close(fd);
+    TEST(0 == memcmp(readback.data() + page + 5, "changed", 7), "Written copy changed", "Written copy doesn't see its own write");
+
+    stats = store->GetStats();
+    TEST(4 == stats.unique_pages && 6 == stats.shared_pages, "Modified page unshared", "After write: {} unique, {} shared", stats.unique_pages, stats.shared_pages);
+
+    // unlinking the last owner of a page drops it from the store
+    qfs.Operation.Unlink("/ddb/defaults");
+    // stale dentry cache entries hold the inode until next lookup drops them
+    quasi_stat_t st;
+    qfs.Operation.Stat("/dda/defaults", &st);
+    stats = store->GetStats();
+    TEST(3 == stats.unique_pages && 3 == stats.shared_pages, "Dead pages leave the store", "After unlink: {} unique, {} shared", stats.unique_pages, stats.shared_pages);
+
+    for (const char *mount : mounts)
+    {
+        qfs.Operation.Unlink(std::string(mount) + "/defaults");
+        qfs.Unmount(mount);
+        qfs.Operation.RMDir(mount);
+    }
+}
+
+void TestInodeNumbers(QFS &qfs)
+{
+    LogTest("Inode number recycling");
+
+    // partition alone, dentry cache would keep unlinked inodes alive
+    partition_ptr part = Partition::Create();
+    dir_ptr root = part->GetRoot();
+
+    file_ptr first = RegularFile::Create();
+    part->touch(root, "first", first);
+    fileno_t first_fileno = first->GetFileno();
+    TEST(first == part->GetInodeByFileno(first_fileno) && first_fileno == first->st.st_ino, "Inode found by number", "Inode {} not found by number", first_fileno);
+
+    // unlinked, but still open somewhere
+    part->unlink(root, "first");
+    file_ptr second = RegularFile::Create();
+    part->touch(root, "second", second);
+    TEST(nullptr == part->GetInodeByFileno(first_fileno) && first_fileno != second->GetFileno(), "Number of live unlinked inode not reused", "Unlinked inode's number {} handed out to {}", first_fileno, second->GetFileno());
+
+    first.reset();
+    file_ptr third = RegularFile::Create();
+    part->touch(root, "third", third);
+    TEST(first_fileno == third->GetFileno() && third == part->GetInodeByFileno(first_fileno), "Released number reused", "Expected number {}, got {}", first_fileno, third->GetFileno());
+
+    TEST(nullptr == part->GetInodeByFileno(-1) && nullptr == part->GetInodeByFileno(1 << 20), "Lookup out of range", "Lookup out of range returned an inode");
+}
+
+void TestInodePool(QFS &qfs)
+{
+    LogTest("Per-partition inode pool");
+
+    partition_ptr part = Partition::Create();
+    dir_ptr root = part->GetRoot();
+    std::weak_ptr<InodePool> pool = part->GetInodePool();
+
+    for (int idx = 0; idx < 1000; idx++)
+        part->touch<RegularFile>(root, "file" + std::to_string(idx));
+    part->touch(root, "link", part->NewInode<Symlink>("file0"));
+    part->mkdir(root, "dir");
+
+    size_t chunks = pool.lock()->ChunkCount();
+    // control block and slot rounding on top of each inode
+    size_t expected = 1002 * (sizeof(RegularFile) + 64) / InodePool::CHUNK_SIZE + 1;
+    TEST(chunks <= expected, "Inodes allocated in bulk", "{} chunks for 1000 inodes, expected at most {}", chunks, expected);
+
+    // freed slot is handed out again
+    inode_ptr victim = root->lookup("file500");
+    const void *victim_addr = victim.get();
+    victim.reset();
+    part->unlink(root, "file500");
+    file_ptr replacement = part->NewInode<RegularFile>();
+    TEST(victim_addr == replacement.get(), "Freed inode slot reused", "Freed slot {} not reused", victim_addr);
+
+    // open files outlive their partition
+    part->touch(root, "survivor", replacement);
+    replacement->write(0, "alive", 5);
+    part.reset();
+    root.reset();
+    char buffer[8]{};
+    TEST(5 == replacement->read(0, buffer, sizeof(buffer)) && 0 == memcmp(buffer, "alive", 5) && !pool.expired(), "Inode outlives its partition", "Inode lost after partition was dropped");
+
+    replacement.reset();
+    TEST(pool.expired(), "Pool released with last inode", "Pool still alive after last inode was dropped");
+}
+
+void TestDirectoryLifetime(QFS &qfs)
+{
+    LogTest("Directory lifetime");
+
+    partition_ptr part = Partition::Create();
+    dir_ptr root = part->GetRoot();
+    std::weak_ptr<Partition> weak_part = part;
+    std::weak_ptr<Directory> weak_root = root;
+    std::weak_ptr<InodePool> pool = part->GetInodePool();
+
+    part->mkdir(root, "a");
+    dir_ptr a = std::static_pointer_cast<Directory>(root->lookup("a"));
+    part->mkdir(a, "b");
+    dir_ptr b = std::static_pointer_cast<Directory>(a->lookup("b"));
+    part->touch<RegularFile>(b, "file");
+
+    TEST(b == b->lookup(".") && a == b->lookup("..") && root == root->lookup(".."), "Relatives resolved", "Relatives point to wrong directories");
+    TEST(3 == a->st.st_nlink && 2 == b->st.st_nlink, "Relatives counted as links", "Wrong link count: a:{} b:{}", a->st.st_nlink, b->st.st_nlink);
+
+    std::weak_ptr<Directory> weak_a = a;
+    std::weak_ptr<Directory> weak_b = b;
+    std::weak_ptr<Inode> weak_file = b->lookup("file");
+
+    // removed subtree is gone as soon as nobody holds it
+    part->unlink(b, "file");
+    part->rmdir(a, "b");
+    part->rmdir(root, "a");
+    b.reset();
+    a.reset();
+    TEST(weak_a.expired() && weak_b.expired() && weak_file.expired(), "Removed subtree released", "Removed subtree leaked: a:{} b:{} file:{}", !weak_a.expired(), !weak_b.expired(), !weak_file.expired());
+
+    // dropped partition takes its tree and pool with it
+    part->mkdir(root, "c");
+    part->touch<RegularFile>(std::static_pointer_cast<Directory>(root->lookup("c")), "file");
+    root.reset();
+    part.reset();
+    TEST(weak_part.expired() && weak_root.expired(), "Dropped partition released", "Dropped partition leaked: partition:{} root:{}", !weak_part.expired(), !weak_root.expired());
+
+    // control blocks (and allocators in them) live as long as any weak reference
+    weak_root.reset();
+    weak_a.reset();
+    weak_b.reset();
+    weak_file.reset();
+    TEST(pool.expired(), "Dropped partition released its pool", "Pool still alive after partition was dropped");
+
+    // same through QFS, dentry cache drops resolutions into the unmounted partition
+    partition_ptr mounted = Partition::Create();
+    std::weak_ptr<Partition> weak_mounted = mounted;
+    std::weak_ptr<Directory> weak_mounted_root = mounted->GetRoot();
+    qfs.Operation.MKDir("/lifetime");
+    qfs.Mount("/lifetime", mounted);
+    mounted.reset();
+    qfs.Operation.MKDir("/lifetime/dir");
+    qfs.Operation.Close(qfs.Operation.Creat("/lifetime/dir/file"));
+    qfs.Unmount("/lifetime");
+    qfs.Operation.RMDir("/lifetime");
+    TEST(weak_mounted.expired() && weak_mounted_root.expired(), "Unmounted partition released", "Unmounted partition leaked: partition:{} root:{}", !weak_mounted.expired(), !weak_mounted_root.expired());
+}
+
+void TestFileDescriptors(QFS &qfs)
+{
+    LogTest("File descriptor allocation");
+
+    qfs.Operation.Close(qfs.Operation.Creat("/fd_alloc"));
+
+    // lowest available first, so these fill every hole below the last one
+    std::vector<int> fds{};
+    for (int idx = 0; idx < 8; idx++)
+        fds.push_back(qfs.Operation.Open("/fd_alloc", QUASI_O_RDONLY));
+
+    TEST(std::is_sorted(fds.begin(), fds.end()) && fds.front() >= 0, "Descriptors allocated in order", "Descriptors out of order: {}..{}", fds.front(), fds.back());
+
+    // freed out of order, handed out lowest first
+    for (int idx : {5, 2, 3})
+        qfs.Operation.Close(fds[idx]);
+    int first = qfs.Operation.Open("/fd_alloc", QUASI_O_RDONLY);
+    int second = qfs.Operation.Open("/fd_alloc", QUASI_O_RDONLY);
+    int third = qfs.Operation.Open("/fd_alloc", QUASI_O_RDONLY);
+    TEST(fds[2] == first && fds[3] == second && fds[5] == third, "Lowest free descriptor reused", "Got {} {} {}, expected {} {} {}", first, second, third, fds[2], fds[3], fds[5]);
+
+    // last one is trimmed off, holes below it are trimmed with it
+    qfs.Operation.Close(fds[6]);
+    qfs.Operation.Close(fds[7]);
+    int reopened = qfs.Operation.Open("/fd_alloc", QUASI_O_RDONLY);
+    TEST(fds[6] == reopened, "Descriptor reused after trimming", "Got {}, expected {}", reopened, fds[6]);
+    fds[6] = reopened;
+
+    for (int idx = 0; idx < 7; idx++)
+        qfs.Operation.Close(fds[idx]);
+    reopened = qfs.Operation.Open("/fd_alloc", QUASI_O_RDONLY);
+    TEST(fds[0] == reopened, "Descriptor reused after closing all", "Got {}, expected {}", reopened, fds[0]);
+    qfs.Operation.Close(reopened);
+
+    TEST(-QUASI_EBADF == qfs.Operation.Close(fds[7]), "Closed descriptor rejected", "Closed descriptor accepted");
+
+    // slots are reused in place, nothing may leak from previous description
+    int writer = qfs.Operation.Open("/fd_alloc", QUASI_O_RDWR | QUASI_O_APPEND);
+    qfs.Operation.Write(writer, "stale", 5);
+    qfs.Operation.Close(writer);
+    int reader = qfs.Operation.Open("/fd_alloc", QUASI_O_RDONLY);
+    TEST(writer == reader && 0 == qfs.Operation.Tell(reader) && -QUASI_EBADF == qfs.Operation.Write(reader, "x", 1), "Reused slot starts clean", "Reused slot {} kept previous state", reader);
+    qfs.Operation.Close(reader);
+
+    qfs.Operation.Unlink("/fd_alloc");
+}
\ No newline at end of file